@@ -0,0 +1,228 @@
+﻿using System;
+using System.Runtime.InteropServices;
+using System.Security.Cryptography;
+
+namespace _666_app
+{
+    // Bindings for engine666.dll, the native 666 cipher engine (SHA256usingC++/SHA256usingC++/engine666).
+    // Text, matrices and encrypted blocks cross as UTF-16, so strings are passed without conversion.
+    // When the DLL is missing, built for the other architecture or lacks an export, the same cipher
+    // runs in managed code.
+    static class Engine666
+    {
+        public const int Matrix = 108;
+        public const int Keys = 18;
+        private const int Digits = 6;
+        private const string InvalidMatrix = "The matrix must be 108 digits and the first six keys positions inside it.";
+
+        private static bool native = true;
+
+        [DllImport("engine666.dll", CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Unicode)]
+        private static extern void engine666_generate([Out] char[] matrix, [Out] int[] keys);
+
+        [DllImport("engine666.dll", CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Unicode)]
+        private static extern long engine666_encrypt(string matrix, int[] keys, string text, long length, [Out] char[] output, int threads);
+
+        [DllImport("engine666.dll", CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Unicode)]
+        private static extern int engine666_decrypt(int[] keys, string input, long count, [Out] char[] output, int threads);
+
+        // A fresh matrix and keys from a cryptographic generator
+        public static void Generate(out string matrix, out int[] keys)
+        {
+            char[] digits = new char[Matrix];
+            keys = new int[Keys];
+            if (native)
+            {
+                try
+                {
+                    engine666_generate(digits, keys);
+                    matrix = new string(digits);
+                    return;
+                }
+                catch (Exception e) when (Unavailable(e))
+                {
+                    native = false;
+                }
+            }
+
+            using (RandomNumberGenerator rng = RandomNumberGenerator.Create())
+            {
+                for (int n = 0; n < Matrix / Digits; n++)
+                {
+                    Convert.ToString(Uniform(rng, 100000, 999999)).CopyTo(0, digits, n * Digits, Digits);
+                }
+                for (int k = 0; k < Keys; k++)
+                {
+                    keys[k] = Uniform(rng, 10, 99);
+                }
+            }
+            matrix = new string(digits);
+        }
+
+        // One block of Matrix digits per character of text; count is the number of blocks, 0 when
+        // key 1 equals key 2, key 3 equals key 4 or key 5 equals key 6
+        public static string Encrypt(string text, string matrix, int[] keys, out int count)
+        {
+            // The engine reads Matrix characters and six keys without knowing the lengths
+            if (matrix == null || matrix.Length != Matrix || keys == null || !ValidKeys(keys))
+            {
+                throw new ArgumentException(InvalidMatrix);
+            }
+
+            char[] output = new char[(long)text.Length * Matrix];
+            long blocks = -1;
+            if (native)
+            {
+                try
+                {
+                    blocks = engine666_encrypt(matrix, keys, text, text.Length, output, 0);
+                }
+                catch (Exception e) when (Unavailable(e))
+                {
+                    native = false;
+                }
+            }
+            if (!native)
+            {
+                blocks = EncryptManaged(text, matrix, keys, output);
+            }
+
+            if (blocks < 0)
+            {
+                throw new ArgumentException(InvalidMatrix);
+            }
+            count = (int)blocks;
+            return new string(output, 0, count * Matrix);
+        }
+
+        public static string Decrypt(string input, int count, int[] keys)
+        {
+            if (count < 0 || (long)count * Matrix > input.Length || !ValidKeys(keys))
+            {
+                throw new ArgumentException("The text does not hold " + count + " encrypted characters for these keys.");
+            }
+
+            char[] output = new char[count];
+            int ok = -1;
+            if (native)
+            {
+                try
+                {
+                    ok = engine666_decrypt(keys, input, count, output, 0);
+                }
+                catch (Exception e) when (Unavailable(e))
+                {
+                    native = false;
+                }
+            }
+            if (!native)
+            {
+                ok = DecryptManaged(input, count, keys, output);
+            }
+
+            if (ok != 1)
+            {
+                throw new FormatException("The text does not hold " + count + " encrypted characters for these keys.");
+            }
+            return new string(output);
+        }
+
+        // Failures to bind the native engine, as opposed to errors raised by it
+        private static bool Unavailable(Exception e)
+        {
+            return e is DllNotFoundException || e is BadImageFormatException || e is EntryPointNotFoundException;
+        }
+
+        private static bool ValidKeys(int[] keys)
+        {
+            if (keys.Length < Digits)
+            {
+                return false;
+            }
+            for (int j = 0; j < Digits; j++)
+            {
+                if (keys[j] < 0 || keys[j] >= Matrix)
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        private static long EncryptManaged(string text, string matrix, int[] keys, char[] output)
+        {
+            if (matrix.Length != Matrix || !ValidKeys(keys))
+            {
+                return -1;
+            }
+            foreach (char c in matrix)
+            {
+                if (c < '0' || c > '9')
+                {
+                    return -1;
+                }
+            }
+            if (keys[0] == keys[1] || keys[2] == keys[3] || keys[4] == keys[5])
+            {
+                return 0;
+            }
+
+            // Every character rewrites all six positions, so one block can be reused throughout
+            char[] block = matrix.ToCharArray();
+            char[] digits = new char[Digits];
+            for (int i = 0; i < text.Length; i++)
+            {
+                int code = text[i];
+                for (int j = Digits - 1; j >= 0; j--, code /= 10)
+                {
+                    digits[j] = (char)('0' + code % 10);
+                }
+                // Later keys win where positions repeat, as in the engine
+                for (int j = 0; j < Digits; j++)
+                {
+                    block[keys[j]] = digits[j];
+                }
+                Array.Copy(block, 0, output, (long)i * Matrix, Matrix);
+            }
+            return text.Length;
+        }
+
+        private static int DecryptManaged(string input, int count, int[] keys, char[] output)
+        {
+            for (int i = 0; i < count; i++)
+            {
+                int code = 0;
+                for (int j = 0; j < Digits; j++)
+                {
+                    int digit = input[i * Matrix + keys[j]] - '0';
+                    if (digit < 0 || digit > 9)
+                    {
+                        return 0;
+                    }
+                    code = code * 10 + digit;
+                }
+                if (code > char.MaxValue)
+                {
+                    return 0;
+                }
+                output[i] = (char)code;
+            }
+            return 1;
+        }
+
+        // Uniform in [low, high) by rejection, so no value is favoured
+        private static int Uniform(RandomNumberGenerator rng, int low, int high)
+        {
+            uint range = (uint)(high - low);
+            uint limit = uint.MaxValue - uint.MaxValue % range;
+            byte[] bytes = new byte[4];
+            uint r;
+            do
+            {
+                rng.GetBytes(bytes);
+                r = BitConverter.ToUInt32(bytes, 0);
+            } while (r >= limit);
+            return low + (int)(r % range);
+        }
+    }
+}
@@ -1,21 +1,122 @@
 package com.biomiid.encryption;
 
+import java.nio.ByteBuffer;
+import java.nio.charset.StandardCharsets;
+import java.security.GeneralSecurityException;
+import java.security.MessageDigest;
+import java.security.SecureRandom;
+import java.util.Arrays;
+import java.util.Base64;
+import javax.crypto.Cipher;
+import javax.crypto.SecretKeyFactory;
+import javax.crypto.spec.IvParameterSpec;
+import javax.crypto.spec.PBEKeySpec;
+import javax.crypto.spec.SecretKeySpec;
 
 
 public class AES {
 
   private static final String SALT = "fa402db659644c9c881cde92013b2901";
-  
+  private static final int ITERATIONS = 65536;
+  private static final int KEY_BITS = 256;
+  // Must name the same hash as factoryInstance
+  private static final int PBKDF2_HASH = NativeCrypto.HASH_SHA1;
+
   private static String factoryInstance = "PBKDF2WithHmacSHA1";
   private static String cipherInstance = "AES/CBC/PKCS5PADDING";
   private static String secretKeyType = "AES";
-  private static byte[] ivCode = new byte[16];
+  private static final int IV_BYTES = 16;
+  private static final SecureRandom RANDOM = new SecureRandom();
+
+  // PBKDF2 is slow on purpose, so the keys of recent passphrases are kept. Entries are found by a
+  // salted digest rather than the passphrase itself, and evicted native keys are freed.
+  private static final int CACHE_SIZE = 256;
+  private static final byte[] CACHE_SALT = salt();
+  private static final KeyCache<Long> nativeKeys = new KeyCache<>(CACHE_SIZE, NativeCrypto::aesFree);
+  private static final KeyCache<SecretKeySpec> jceKeys = new KeyCache<>(CACHE_SIZE, null);
+  private static final ThreadLocal<Cipher> ciphers = ThreadLocal.withInitial(() -> {
+    try {
+      return Cipher.getInstance(cipherInstance);
+    } catch (GeneralSecurityException e) {
+      throw new IllegalStateException(e);
+    }
+  });
  
   public static String encrypt(String data, String aesKey) {
-    
+    try {
+      // A fresh IV per message, sent ahead of the ciphertext, so equal plaintexts under one passphrase never match
+      byte[] iv = new byte[IV_BYTES];
+      RANDOM.nextBytes(iv);
+      byte[] plain = data.getBytes(StandardCharsets.UTF_8);
+      byte[] encrypted = NativeCrypto.isAvailable() ? encryptNative(plain, aesKey, iv) : encryptJce(plain, aesKey, iv);
+      return Base64.getEncoder().encodeToString(encrypted);
+    } catch (Exception e) {
+      System.out.println("Error while encrypting: " + e.toString());
+    }
     return null;
   }
-  
+
+  private static byte[] encryptNative(byte[] plain, String aesKey, byte[] iv) throws GeneralSecurityException {
+    try (KeyCache<Long>.Lease key = nativeKeys.acquire(cacheId(aesKey), () -> {
+      byte[] derived = deriveKey(aesKey);
+      try {
+        return NativeCrypto.aesKey(derived);
+      } finally {
+        Arrays.fill(derived, (byte) 0);
+      }
+    })) {
+      ByteBuffer in = NativeCrypto.scratch(0, plain.length);
+      in.put(plain);
+      ByteBuffer out = NativeCrypto.scratch(1, plain.length + 16);
+      int length = NativeCrypto.aesCbcEncrypt(key.value(), iv, in, 0, plain.length, out, 0);
+      byte[] encrypted = Arrays.copyOf(iv, IV_BYTES + length);
+      out.get(encrypted, IV_BYTES, length);
+      return encrypted;
+    }
+  }
+
+  private static byte[] encryptJce(byte[] plain, String aesKey, byte[] iv) throws GeneralSecurityException {
+    try (KeyCache<SecretKeySpec>.Lease key = jceKeys.acquire(cacheId(aesKey), () -> new SecretKeySpec(deriveKey(aesKey), secretKeyType))) {
+      Cipher cipher = ciphers.get();
+      cipher.init(Cipher.ENCRYPT_MODE, key.value(), new IvParameterSpec(iv));
+      byte[] encrypted = Arrays.copyOf(iv, IV_BYTES + cipher.getOutputSize(plain.length));
+      int length = cipher.doFinal(plain, 0, plain.length, encrypted, IV_BYTES);
+      return Arrays.copyOf(encrypted, IV_BYTES + length);
+    }
+  }
+
+  private static byte[] salt() {
+    byte[] salt = new byte[16];
+    RANDOM.nextBytes(salt);
+    return salt;
+  }
+
+  // Salted with a per-process random value, so the cache holds nothing that can be checked against guesses offline
+  private static String cacheId(String aesKey) throws GeneralSecurityException {
+    byte[] passphrase = aesKey.getBytes(StandardCharsets.UTF_8);
+    try {
+      MessageDigest digest = MessageDigest.getInstance("SHA-256");
+      digest.update(CACHE_SALT);
+      return Base64.getEncoder().encodeToString(digest.digest(passphrase));
+    } finally {
+      Arrays.fill(passphrase, (byte) 0);
+    }
+  }
+
+  private static byte[] deriveKey(String aesKey) {
+    byte[] salt = SALT.getBytes(StandardCharsets.UTF_8);
+    byte[] key = new byte[KEY_BITS / 8];
+    if (NativeCrypto.supports(PBKDF2_HASH)) {
+      NativeCrypto.pbkdf2(PBKDF2_HASH, aesKey.getBytes(StandardCharsets.UTF_8), salt, ITERATIONS, key);
+      return key;
+    }
+
+    try {
+      SecretKeyFactory factory = SecretKeyFactory.getInstance(factoryInstance);
+      return factory.generateSecret(new PBEKeySpec(aesKey.toCharArray(), salt, ITERATIONS, KEY_BITS)).getEncoded();
+    } catch (GeneralSecurityException e) {
+      throw new IllegalStateException(e);
+    }
+  }
   
 }
-
@@ -0,0 +1,121 @@
+package com.biomiid.encryption;
+
+import java.util.ArrayList;
+import java.util.Collections;
+import java.util.Iterator;
+import java.util.LinkedHashMap;
+import java.util.List;
+import java.util.Map;
+import java.util.function.Consumer;
+import java.util.function.Supplier;
+
+/**
+ * Bounded least-recently-used cache of derived or parsed keys, such as native key handles.
+ * Callers use a value through a lease; an entry evicted while leased is released only when its
+ * last lease closes, so a handle is never freed under a thread that is still encrypting with it.
+ */
+final class KeyCache<V> {
+
+	final class Lease implements AutoCloseable {
+		private final Entry entry;
+		private boolean closed;
+
+		private Lease(Entry entry) {
+			this.entry = entry;
+		}
+
+		V value() {
+			return entry.value;
+		}
+
+		@Override
+		public void close() {
+			if (!closed) {
+				closed = true;
+				release(entry);
+			}
+		}
+	}
+
+	private final class Entry {
+		final V value;
+		int leases;
+		boolean evicted;
+
+		Entry(V value) {
+			this.value = value;
+		}
+	}
+
+	private final int capacity;
+	private final Consumer<V> free;
+	private final LinkedHashMap<String, Entry> entries = new LinkedHashMap<>(16, 0.75f, true);
+
+	/** free releases an evicted value, or is null when values need no release. */
+	KeyCache(int capacity, Consumer<V> free) {
+		this.capacity = capacity;
+		this.free = free;
+	}
+
+	/** Leases the value cached under id, loading it first if absent. */
+	Lease acquire(String id, Supplier<V> load) {
+		synchronized (this) {
+			Entry entry = entries.get(id);
+			if (entry != null) {
+				entry.leases++;
+				return new Lease(entry);
+			}
+		}
+
+		// Loading is slow (PBKDF2, key parsing), so it runs outside the lock; if another thread
+		// loaded the same id meanwhile, its entry wins and this value is dropped
+		V value = load.get();
+		Entry entry;
+		List<V> dropped = new ArrayList<>();
+		synchronized (this) {
+			entry = entries.get(id);
+			if (entry == null) {
+				entry = new Entry(value);
+				entries.put(id, entry);
+				evict(dropped);
+			}
+			else {
+				dropped.add(value);
+			}
+			entry.leases++;
+		}
+		release(dropped);
+		return new Lease(entry);
+	}
+
+	private void evict(List<V> dropped) {
+		Iterator<Map.Entry<String, Entry>> eldest = entries.entrySet().iterator();
+		while (entries.size() > capacity && eldest.hasNext()) {
+			Entry entry = eldest.next().getValue();
+			eldest.remove();
+			entry.evicted = true;
+			if (entry.leases == 0) {
+				dropped.add(entry.value);
+			}
+		}
+	}
+
+	private void release(Entry entry) {
+		synchronized (this) {
+			entry.leases--;
+			if (!entry.evicted || entry.leases > 0) {
+				return;
+			}
+		}
+		release(Collections.singletonList(entry.value));
+	}
+
+	private void release(List<V> values) {
+		if (free != null) {
+			for (V value : values) {
+				free.accept(value);
+			}
+		}
+	}
+
+}
@@ -0,0 +1,92 @@
+package com.biomiid.encryption;
+
+import java.nio.ByteBuffer;
+
+/**
+ * JNI bindings to the native crypto core (libnativecrypto, built from SHA256usingC++/SHA256usingC++/jni).
+ *
+ * Buffers must be direct so the native side reads and writes them in place. Keys are parsed once
+ * into native handles; callers cache them and release them with the matching free method.
+ * Everything here is safe to call from several threads, including on the same handle.
+ */
+public final class NativeCrypto {
+
+	public static final int HASH_SHA1 = 1;
+	public static final int HASH_SHA256 = 2;
+	public static final int HASH_SHA512 = 3;
+
+	private static final boolean LOADED = load();
+
+	// Per-thread direct buffers reused across calls, so steady-state traffic allocates nothing off-heap
+	private static final ThreadLocal<ByteBuffer[]> SCRATCH = ThreadLocal.withInitial(() -> new ByteBuffer[2]);
+
+	private NativeCrypto() {
+	}
+
+	private static boolean load() {
+		try {
+			System.loadLibrary("nativecrypto");
+			return true;
+		} catch (UnsatisfiedLinkError e) {
+			return false;
+		}
+	}
+
+	/** A cleared direct buffer of at least size bytes; slot 0 and 1 are separate buffers for input and output. */
+	static ByteBuffer scratch(int slot, int size) {
+		ByteBuffer[] buffers = SCRATCH.get();
+		if (buffers[slot] == null || buffers[slot].capacity() < size) {
+			buffers[slot] = ByteBuffer.allocateDirect(Math.max(size, 4096));
+		}
+		buffers[slot].clear();
+		return buffers[slot];
+	}
+
+	/** True when the library is loaded. */
+	public static boolean isAvailable() {
+		return LOADED;
+	}
+
+	/** True when the library is loaded and implements OAEP and PBKDF2 with the given hash. */
+	public static boolean supports(int hash) {
+		return LOADED && nativeSupports(hash);
+	}
+
+	private static native boolean nativeSupports(int hash);
+
+	/** Parses an X.509 SubjectPublicKeyInfo or PKCS#1 RSAPublicKey. */
+	public static native long rsaPublicKey(byte[] der);
+
+	public static native void rsaFree(long key);
+
+	/** Modulus size in bytes, which is also the ciphertext size. */
+	public static native int rsaSize(long key);
+
+	/** RSA-OAEP with MGF1 over the same hash and an empty label. Returns the bytes written. */
+	public static native int rsaEncrypt(long key, int hash, ByteBuffer in, int inOffset, int length, ByteBuffer out, int outOffset);
+
+	/**
+	 * Encrypts count messages in one call: message i is in[offsets[i], offsets[i + 1]) and its
+	 * ciphertext is written at outOffset + i * rsaSize(key).
+	 */
+	public static native int rsaEncryptBatch(long key, int hash, ByteBuffer in, int[] offsets, int count, ByteBuffer out, int outOffset);
+
+	/** PBKDF2 with HMAC over the given hash, filling out. */
+	public static native boolean pbkdf2(int hash, byte[] password, byte[] salt, int iterations, byte[] out);
+
+	/** Expands a 16, 24 or 32 byte AES key. */
+	public static native long aesKey(byte[] key);
+
+	public static native void aesFree(long key);
+
+	/**
+	 * AES/CBC/PKCS5Padding encryption. out needs room for (length / 16 + 1) * 16 bytes; returns
+	 * the bytes written.
+	 */
+	public static native int aesCbcEncrypt(long key, byte[] iv, ByteBuffer in, int inOffset, int length, ByteBuffer out, int outOffset);
+
+	public static native void sha256(ByteBuffer in, int inOffset, int length, ByteBuffer out, int outOffset);
+
+	/** Hashes count items laid out like rsaEncryptBatch's; digest i goes to outOffset + 32 * i. */
+	public static native void sha256Batch(ByteBuffer in, int[] offsets, int count, ByteBuffer out, int outOffset);
+}
@@ -1,5 +1,8 @@
 package com.biomiid.encryption;
 
+import java.nio.ByteBuffer;
+import java.nio.charset.StandardCharsets;
+import java.security.GeneralSecurityException;
 import java.security.KeyFactory;
 import java.security.PublicKey;
 import java.security.spec.X509EncodedKeySpec;
@@ -8,23 +11,98 @@ import javax.crypto.Cipher;
 
 
 public class RSA {
-	
+
+	private static final String TRANSFORMATION = "RSA/ECB/OAEPWithSHA-1AndMGF1Padding";
+	private static final int OAEP_HASH = NativeCrypto.HASH_SHA1;
+
+	// Keys by their base64 text. Services encrypt to a handful of fixed keys, which stay cached;
+	// the bound only stops a caller cycling through many keys from leaking native handles.
+	private static final int CACHE_SIZE = 64;
+	private static final KeyCache<Long> nativeKeys = new KeyCache<>(CACHE_SIZE, NativeCrypto::rsaFree);
+	private static final KeyCache<PublicKey> jceKeys = new KeyCache<>(CACHE_SIZE, null);
+	private static final ThreadLocal<Cipher> ciphers = ThreadLocal.withInitial(() -> {
+		try {
+			return Cipher.getInstance(TRANSFORMATION);
+		} catch (GeneralSecurityException e) {
+			throw new IllegalStateException(e);
+		}
+	});
+
 	public static String encrypt(String data, String publicKey) {
-	    try {
-	    	  Cipher cipher = Cipher.getInstance("RSA/ECB/OAEPWithSHA-1AndMGF1Padding");
-              byte[] publicBytes = Base64.getDecoder().decode(publicKey.getBytes("UTF-8"));
-              X509EncodedKeySpec keySpec = new X509EncodedKeySpec(publicBytes);
-              KeyFactory keyFactory = KeyFactory.getInstance("RSA");
-              PublicKey pubKey = keyFactory.generatePublic(keySpec);
-              cipher.init(Cipher.ENCRYPT_MODE, pubKey);
-   
-              byte[] encryptedBytes = cipher.doFinal(data.getBytes("UTF-8"));
-		      return Base64.getEncoder().encodeToString(encryptedBytes);
-	    } catch (Exception e) {
-	          System.out.println("Error while encrypting: " + e.toString());
-	    }
-	    return null;
-	  }
-	
+		String[] encrypted = encrypt(new String[] { data }, publicKey);
+		return encrypted == null ? null : encrypted[0];
+	}
+
+	/** Encrypts every entry to the same key; on the native path the whole batch is one call. */
+	public static String[] encrypt(String[] data, String publicKey) {
+		try {
+			byte[][] messages = new byte[data.length][];
+			for (int i = 0; i < data.length; i++) {
+				messages[i] = data[i].getBytes(StandardCharsets.UTF_8);
+			}
+
+			byte[][] encrypted = NativeCrypto.supports(OAEP_HASH) ? encryptNative(messages, publicKey) : encryptJce(messages, publicKey);
+
+			Base64.Encoder encoder = Base64.getEncoder();
+			String[] result = new String[data.length];
+			for (int i = 0; i < data.length; i++) {
+				result[i] = encoder.encodeToString(encrypted[i]);
+			}
+			return result;
+		} catch (Exception e) {
+			System.out.println("Error while encrypting: " + e.toString());
+		}
+		return null;
+	}
+
+	private static byte[][] encryptNative(byte[][] messages, String publicKey) {
+		try (KeyCache<Long>.Lease lease = nativeKeys.acquire(publicKey, () -> NativeCrypto.rsaPublicKey(Base64.getDecoder().decode(publicKey)))) {
+			return encryptNative(messages, lease.value());
+		}
+	}
+
+	private static byte[][] encryptNative(byte[][] messages, long key) {
+		int size = NativeCrypto.rsaSize(key);
+
+		int[] offsets = new int[messages.length + 1];
+		for (int i = 0; i < messages.length; i++) {
+			offsets[i + 1] = offsets[i] + messages[i].length;
+		}
+		ByteBuffer in = NativeCrypto.scratch(0, offsets[messages.length]);
+		for (byte[] message : messages) {
+			in.put(message);
+		}
+		ByteBuffer out = NativeCrypto.scratch(1, messages.length * size);
+
+		NativeCrypto.rsaEncryptBatch(key, OAEP_HASH, in, offsets, messages.length, out, 0);
+
+		byte[][] result = new byte[messages.length][size];
+		for (byte[] encrypted : result) {
+			out.get(encrypted);
+		}
+		return result;
+	}
+
+	private static byte[][] encryptJce(byte[][] messages, String publicKey) throws GeneralSecurityException {
+		Cipher cipher = ciphers.get();
+		try (KeyCache<PublicKey>.Lease key = jceKeys.acquire(publicKey, () -> decodeKey(publicKey))) {
+			cipher.init(Cipher.ENCRYPT_MODE, key.value());
+		}
+
+		byte[][] result = new byte[messages.length][];
+		for (int i = 0; i < messages.length; i++) {
+			result[i] = cipher.doFinal(messages[i]);
+		}
+		return result;
+	}
+
+	private static PublicKey decodeKey(String publicKey) {
+		try {
+			X509EncodedKeySpec keySpec = new X509EncodedKeySpec(Base64.getDecoder().decode(publicKey));
+			return KeyFactory.getInstance("RSA").generatePublic(keySpec);
+		} catch (GeneralSecurityException e) {
+			throw new IllegalArgumentException(e);
+		}
+	}
 
 }
@@ -5,10 +5,16 @@ from Crypto.Hash import SHA512, SHA384, SHA256, SHA, MD5
 from Crypto import Random
 from base64 import b64encode, b64decode
 
+try:
+    # Native per-thread ChaCha20 generator, built from SHA256usingC++/SHA256usingC++/python
+    from nativehash import random as random_bytes
+except ImportError:
+    random_bytes = Random.new().read
+
 hash = "SHA-256"
 
 def newkeys(keysize):
-    random_generator = Random.new().read
+    random_generator = random_bytes
     key = RSA.generate(keysize, random_generator)
     private, public = key, key.publickey()
     return public, private
@@ -0,0 +1,351 @@
+#include "AES.h"
+#include <cstring>
+
+#ifdef AES_HARDWARE
+#include <immintrin.h>
+#include <wmmintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+// Boyar-Peralta S-box circuit (depth 16, 113 gates) on bit slices: q[b] holds bit b of up to
+// 32 bytes. Only XOR, AND and NOT, so no byte value decides a memory address or a branch.
+static void sboxSlices(uint32_t* q) {
+	uint32_t x0 = q[7], x1 = q[6], x2 = q[5], x3 = q[4], x4 = q[3], x5 = q[2], x6 = q[1], x7 = q[0];
+
+	// Top linear transformation
+	uint32_t y14 = x3 ^ x5, y13 = x0 ^ x6, y9 = x0 ^ x3, y8 = x0 ^ x5;
+	uint32_t t0 = x1 ^ x2;
+	uint32_t y1 = t0 ^ x7;
+	uint32_t y4 = y1 ^ x3, y12 = y13 ^ y14, y2 = y1 ^ x0, y5 = y1 ^ x6;
+	uint32_t y3 = y5 ^ y8;
+	uint32_t t1 = x4 ^ y12;
+	uint32_t y15 = t1 ^ x5, y20 = t1 ^ x1;
+	uint32_t y6 = y15 ^ x7, y10 = y15 ^ t0, y11 = y20 ^ y9;
+	uint32_t y7 = x7 ^ y11, y17 = y10 ^ y11, y19 = y10 ^ y8, y16 = t0 ^ y11;
+	uint32_t y21 = y13 ^ y16, y18 = x0 ^ y16;
+
+	// Inversion in GF(2^4)^2
+	uint32_t t2 = y12 & y15, t3 = y3 & y6, t5 = y4 & x7, t7 = y13 & y16, t8 = y5 & y1;
+	uint32_t t10 = y2 & y7, t12 = y9 & y11, t13 = y14 & y17, t15 = y8 & y10;
+	uint32_t t4 = t3 ^ t2, t6 = t5 ^ t2, t9 = t8 ^ t7, t11 = t10 ^ t7, t14 = t13 ^ t12, t16 = t15 ^ t12;
+	uint32_t t21 = t4 ^ t14 ^ y20, t22 = t6 ^ t16 ^ y19, t23 = t9 ^ t14 ^ y21, t24 = t11 ^ t16 ^ y18;
+	uint32_t t25 = t21 ^ t22, t26 = t21 & t23;
+	uint32_t t27 = t24 ^ t26;
+	uint32_t t29 = (t25 & t27) ^ t22;
+	uint32_t t33 = ((t22 ^ t26) & (t23 ^ t24)) ^ t24;
+	uint32_t t34 = t23 ^ t33, t35 = t27 ^ t33;
+	uint32_t t36 = t24 & t35;
+	uint32_t t37 = t36 ^ t34, t38 = t27 ^ t36;
+	uint32_t t40 = t25 ^ (t29 & t38);
+	uint32_t t41 = t40 ^ t37, t42 = t29 ^ t33, t43 = t29 ^ t40, t44 = t33 ^ t37;
+	uint32_t t45 = t42 ^ t41;
+	uint32_t z0 = t44 & y15, z1 = t37 & y6, z2 = t33 & x7, z3 = t43 & y16, z4 = t40 & y1, z5 = t29 & y7;
+	uint32_t z6 = t42 & y11, z7 = t45 & y17, z8 = t41 & y10, z9 = t44 & y12, z10 = t37 & y3, z11 = t33 & y4;
+	uint32_t z12 = t43 & y13, z13 = t40 & y5, z14 = t29 & y2, z15 = t42 & y9, z16 = t45 & y14, z17 = t41 & y8;
+
+	// Bottom linear transformation
+	uint32_t t46 = z15 ^ z16, t47 = z10 ^ z11, t48 = z5 ^ z13, t49 = z9 ^ z10, t50 = z2 ^ z12;
+	uint32_t t51 = z2 ^ z5, t52 = z7 ^ z8, t53 = z0 ^ z3, t54 = z6 ^ z7, t55 = z16 ^ z17;
+	uint32_t t56 = z12 ^ t48, t57 = t50 ^ t53, t58 = z4 ^ t46, t59 = z3 ^ t54;
+	uint32_t t60 = t46 ^ t57, t61 = z14 ^ t57, t62 = t52 ^ t58, t63 = t49 ^ t58, t64 = z4 ^ t59;
+	uint32_t t65 = t61 ^ t62, t66 = z1 ^ t63;
+	uint32_t t67 = t64 ^ t65;
+	uint32_t s3 = t53 ^ t66;
+
+	q[7] = t59 ^ t63;
+	q[6] = t64 ^ ~s3;
+	q[5] = t55 ^ ~t67;
+	q[4] = s3;
+	q[3] = t51 ^ t66;
+	q[2] = t47 ^ t65;
+	q[1] = t56 ^ ~t62;
+	q[0] = t48 ^ ~t60;
+}
+
+// Transposes the 8x8 bit matrix whose rows are the bytes of x: afterwards byte b holds bit b of every byte
+static inline uint64_t transpose8(uint64_t x) {
+	uint64_t t;
+	t = (x ^ (x >> 7)) & 0x00aa00aa00aa00aaULL;
+	x ^= t ^ (t << 7);
+	t = (x ^ (x >> 14)) & 0x0000cccc0000ccccULL;
+	x ^= t ^ (t << 14);
+	t = (x ^ (x >> 28)) & 0x00000000f0f0f0f0ULL;
+	x ^= t ^ (t << 28);
+	return x;
+}
+
+// SubBytes on 16 bytes, bitsliced so it runs in constant time
+static void subBytes(uint8_t* s) {
+	uint64_t half[2] = { 0, 0 };
+	for (uint8_t i = 0; i < 16; i++) {
+		half[i / 8] |= (uint64_t)s[i] << (8 * (i % 8));
+	}
+	half[0] = transpose8(half[0]);
+	half[1] = transpose8(half[1]);
+
+	uint32_t q[8];
+	for (uint8_t b = 0; b < 8; b++) {
+		q[b] = (uint32_t)((half[0] >> (8 * b)) & 0xff) | ((uint32_t)((half[1] >> (8 * b)) & 0xff) << 8);
+	}
+	sboxSlices(q);
+	half[0] = half[1] = 0;
+	for (uint8_t b = 0; b < 8; b++) {
+		half[0] |= (uint64_t)(q[b] & 0xff) << (8 * b);
+		half[1] |= (uint64_t)((q[b] >> 8) & 0xff) << (8 * b);
+	}
+
+	half[0] = transpose8(half[0]);
+	half[1] = transpose8(half[1]);
+	for (uint8_t i = 0; i < 16; i++) {
+		s[i] = (uint8_t)(half[i / 8] >> (8 * (i % 8)));
+	}
+}
+
+static inline uint8_t xtime(uint8_t x) {
+	return (uint8_t)((x << 1) ^ ((x >> 7) * 0x1b));
+}
+
+static inline uint32_t load32(const uint8_t* p) {
+	return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+static inline void store32(uint8_t* p, uint32_t v) {
+	p[0] = (uint8_t)(v >> 24);
+	p[1] = (uint8_t)(v >> 16);
+	p[2] = (uint8_t)(v >> 8);
+	p[3] = (uint8_t)v;
+}
+
+AES::AES(const uint8_t* key, size_t length) : m_rounds(0), m_valid(length == 16 || length == 24 || length == 32), m_hardware(accelerated()) {
+	// A bad length leaves an all-zero schedule with no rounds rather than one sized off the end
+	memset(m_roundKeys, 0, sizeof(m_roundKeys));
+	if (m_valid) {
+		expandKey(key, length);
+	}
+}
+
+bool AES::valid() const {
+	return m_valid;
+}
+
+AES::~AES() {
+	// Round keys are key material
+	volatile uint8_t* p = m_roundKeys;
+	for (size_t i = 0; i < sizeof(m_roundKeys); i++) {
+		p[i] = 0;
+	}
+}
+
+bool AES::accelerated() {
+#ifdef AES_HARDWARE
+#ifdef _MSC_VER
+	static const bool available = [] {
+		int info[4];
+		__cpuid(info, 1);
+		return (info[2] & (1 << 25)) && (info[2] & (1 << 1)) && (info[2] & (1 << 19));
+	}();
+#else
+	static const bool available = __builtin_cpu_supports("aes") && __builtin_cpu_supports("pclmul") && __builtin_cpu_supports("sse4.1");
+#endif
+	return available;
+#else
+	return false;
+#endif
+}
+
+void AES::expandKey(const uint8_t* key, size_t length) {
+	static const uint8_t rcon[10] = { 0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80, 0x1b, 0x36 };
+	size_t nk = length / 4;
+	m_rounds = (int)nk + 6;
+
+	// FIPS 197 section 5.2, one 32-bit word at a time. SubWord acts on each byte alone, so
+	// it can come before RotWord.
+	memcpy(m_roundKeys, key, length);
+	for (size_t i = nk; i < 4 * (size_t)(m_rounds + 1); i++) {
+		uint8_t t[4];
+		memcpy(t, m_roundKeys + (i - 1) * 4, 4);
+		if (i % nk == 0 || (nk > 6 && i % nk == 4)) {
+			subWord(t);
+		}
+		if (i % nk == 0) {
+			uint8_t first = t[0];
+			t[0] = t[1] ^ rcon[i / nk - 1];
+			t[1] = t[2];
+			t[2] = t[3];
+			t[3] = first;
+		}
+		for (uint8_t j = 0; j < 4; j++) {
+			m_roundKeys[i * 4 + j] = m_roundKeys[(i - nk) * 4 + j] ^ t[j];
+		}
+	}
+}
+
+void AES::subWord(uint8_t* word) const {
+#ifdef AES_HARDWARE
+	if (m_hardware) {
+		subWordHardware(word);
+		return;
+	}
+#endif
+	uint8_t s[16] = { word[0], word[1], word[2], word[3] };
+	subBytes(s);
+	memcpy(word, s, 4);
+}
+
+void AES::encryptBlock(const uint8_t* in, uint8_t* out) const {
+#ifdef AES_HARDWARE
+	if (m_hardware) {
+		encryptHardware(in, out);
+		return;
+	}
+#endif
+	encryptPortable(in, out);
+}
+
+void AES::encryptPortable(const uint8_t* in, uint8_t* out) const {
+	uint8_t s[16], t[16];
+
+	for (uint8_t i = 0; i < 16; i++) {
+		s[i] = in[i] ^ m_roundKeys[i];
+	}
+
+	for (int round = 1; round <= m_rounds; round++) {
+		// ShiftRows then SubBytes, which commute; byte i is row i % 4 of column i / 4
+		for (uint8_t i = 0; i < 16; i++) {
+			t[i] = s[(i + 4 * (i % 4)) % 16];
+		}
+		subBytes(t);
+
+		if (round < m_rounds) {
+			for (uint8_t c = 0; c < 16; c += 4) {
+				uint8_t a0 = t[c], a1 = t[c + 1], a2 = t[c + 2], a3 = t[c + 3];
+				uint8_t all = a0 ^ a1 ^ a2 ^ a3;
+				t[c] ^= all ^ xtime(a0 ^ a1);
+				t[c + 1] ^= all ^ xtime(a1 ^ a2);
+				t[c + 2] ^= all ^ xtime(a2 ^ a3);
+				t[c + 3] ^= all ^ xtime(a3 ^ a0);
+			}
+		}
+
+		for (uint8_t i = 0; i < 16; i++) {
+			s[i] = t[i] ^ m_roundKeys[round * 16 + i];
+		}
+	}
+
+	memcpy(out, s, 16);
+}
+
+void AES::ctr(uint8_t* counter, const uint8_t* in, uint8_t* out, size_t length) const {
+	size_t blocks = length / 16;
+
+#ifdef AES_HARDWARE
+	if (m_hardware) {
+		ctrHardware(counter, in, out, blocks);
+	}
+	else
+#endif
+	{
+		uint8_t keystream[16];
+		for (size_t b = 0; b < blocks; b++) {
+			encryptPortable(counter, keystream);
+			for (uint8_t i = 0; i < 16; i++) {
+				out[b * 16 + i] = in[b * 16 + i] ^ keystream[i];
+			}
+			store32(counter + 12, load32(counter + 12) + 1);
+		}
+	}
+
+	size_t rest = length % 16;
+	if (rest) {
+		uint8_t keystream[16];
+		encryptBlock(counter, keystream);
+		for (size_t i = 0; i < rest; i++) {
+			out[blocks * 16 + i] = in[blocks * 16 + i] ^ keystream[i];
+		}
+		store32(counter + 12, load32(counter + 12) + 1);
+	}
+}
+
+void AES::cbc(uint8_t* iv, const uint8_t* in, uint8_t* out, size_t blocks) const {
+	// Each block depends on the previous ciphertext, so unlike CTR this cannot be interleaved
+	uint8_t x[16];
+	for (size_t b = 0; b < blocks; b++) {
+		for (uint8_t i = 0; i < 16; i++) {
+			x[i] = in[b * 16 + i] ^ iv[i];
+		}
+		encryptBlock(x, out + b * 16);
+		memcpy(iv, out + b * 16, 16);
+	}
+}
+
+#ifdef AES_HARDWARE
+
+void AES::subWordHardware(uint8_t* word) const {
+	// The S-box table would index memory with key bytes. With the word in all four columns,
+	// ShiftRows only swaps equal bytes and AESENCLAST with a zero round key is SubBytes.
+	uint32_t w;
+	memcpy(&w, word, 4);
+	w = (uint32_t)_mm_cvtsi128_si32(_mm_aesenclast_si128(_mm_set1_epi32((int)w), _mm_setzero_si128()));
+	memcpy(word, &w, 4);
+}
+
+void AES::encryptHardware(const uint8_t* in, uint8_t* out) const {
+	__m128i b = _mm_xor_si128(_mm_loadu_si128((const __m128i*)in), _mm_load_si128((const __m128i*)m_roundKeys));
+	for (int r = 1; r < m_rounds; r++) {
+		b = _mm_aesenc_si128(b, _mm_load_si128((const __m128i*)(m_roundKeys + r * 16)));
+	}
+	b = _mm_aesenclast_si128(b, _mm_load_si128((const __m128i*)(m_roundKeys + m_rounds * 16)));
+	_mm_storeu_si128((__m128i*)out, b);
+}
+
+void AES::ctrHardware(uint8_t* counter, const uint8_t* in, uint8_t* out, size_t blocks) const {
+	const size_t WIDE = 8;
+	__m128i keys[15];
+	for (int r = 0; r <= m_rounds; r++) {
+		keys[r] = _mm_load_si128((const __m128i*)(m_roundKeys + r * 16));
+	}
+
+	// Counter blocks are only built as bytes here; eight independent blocks keep the AES unit busy
+	uint32_t next = load32(counter + 12);
+	alignas(16) uint8_t blocksIn[WIDE][16];
+	for (size_t j = 0; j < WIDE; j++) {
+		memcpy(blocksIn[j], counter, 12);
+	}
+
+	size_t b = 0;
+	for (; b + WIDE <= blocks; b += WIDE) {
+		__m128i x[WIDE];
+		for (size_t j = 0; j < WIDE; j++) {
+			store32(blocksIn[j] + 12, next + (uint32_t)j);
+			x[j] = _mm_xor_si128(_mm_load_si128((const __m128i*)blocksIn[j]), keys[0]);
+		}
+		for (int r = 1; r < m_rounds; r++) {
+			for (size_t j = 0; j < WIDE; j++) {
+				x[j] = _mm_aesenc_si128(x[j], keys[r]);
+			}
+		}
+		for (size_t j = 0; j < WIDE; j++) {
+			x[j] = _mm_aesenclast_si128(x[j], keys[m_rounds]);
+			__m128i data = _mm_loadu_si128((const __m128i*)(in + (b + j) * 16));
+			_mm_storeu_si128((__m128i*)(out + (b + j) * 16), _mm_xor_si128(data, x[j]));
+		}
+		next += (uint32_t)WIDE;
+	}
+
+	for (; b < blocks; b++) {
+		store32(blocksIn[0] + 12, next++);
+		__m128i x = _mm_xor_si128(_mm_load_si128((const __m128i*)blocksIn[0]), keys[0]);
+		for (int r = 1; r < m_rounds; r++) {
+			x = _mm_aesenc_si128(x, keys[r]);
+		}
+		x = _mm_aesenclast_si128(x, keys[m_rounds]);
+		__m128i data = _mm_loadu_si128((const __m128i*)(in + b * 16));
+		_mm_storeu_si128((__m128i*)(out + b * 16), _mm_xor_si128(data, x));
+	}
+
+	store32(counter + 12, next);
+}
+
+#endif
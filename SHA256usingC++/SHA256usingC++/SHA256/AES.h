@@ -0,0 +1,61 @@
+#ifndef AES_H
+#define AES_H
+
+#include <cstddef>
+#include <cstdint>
+
+// AES-NI and PCLMULQDQ are used when the CPU has them. Define AES_NO_HARDWARE to build
+// the portable code only.
+#if (defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)) && !defined(AES_NO_HARDWARE)
+#define AES_HARDWARE 1
+#if defined(__GNUC__)
+#define AES_HARDWARE_TARGET __attribute__((target("aes,pclmul,sse4.1")))
+#else
+#define AES_HARDWARE_TARGET
+#endif
+#endif
+
+// AES block cipher, forward direction only (enough for CTR, GCM and CBC encryption).
+//
+// Without AES-NI, SubBytes runs as a bitsliced Boolean circuit instead of the usual S-box
+// table, so the portable path is constant time too; --timing covers both.
+class AES {
+
+public:
+	static constexpr size_t BLOCK = 16;
+
+	// 16, 24 or 32 byte keys; any other length gives a key that is not valid().
+	AES(const uint8_t* key, size_t length);
+	~AES();
+
+	bool valid() const;
+
+	void encryptBlock(const uint8_t* in, uint8_t* out) const;
+
+	// CTR mode with the GCM counter layout: the last 4 bytes of counter are a big endian
+	// block counter that wraps. XORs the keystream into in and advances counter.
+	void ctr(uint8_t* counter, const uint8_t* in, uint8_t* out, size_t length) const;
+
+	// CBC encryption of whole blocks; iv is replaced by the last ciphertext block so calls chain.
+	void cbc(uint8_t* iv, const uint8_t* in, uint8_t* out, size_t blocks) const;
+
+	// True when AES-NI and carry-less multiply are available.
+	static bool accelerated();
+
+private:
+	alignas(16) uint8_t m_roundKeys[15 * 16];
+	int m_rounds;
+	bool m_valid;
+	bool m_hardware;
+
+	void expandKey(const uint8_t* key, size_t length);
+	void subWord(uint8_t* word) const;
+	void encryptPortable(const uint8_t* in, uint8_t* out) const;
+#ifdef AES_HARDWARE
+	AES_HARDWARE_TARGET void subWordHardware(uint8_t* word) const;
+	AES_HARDWARE_TARGET void ctrHardware(uint8_t* counter, const uint8_t* in, uint8_t* out, size_t blocks) const;
+	AES_HARDWARE_TARGET void encryptHardware(const uint8_t* in, uint8_t* out) const;
+#endif
+};
+
+#endif
@@ -0,0 +1,320 @@
+#include "BigInt.h"
+#include "Random.h"
+#include <algorithm>
+
+BigInt::BigInt() {
+}
+
+BigInt::BigInt(uint32_t value) {
+	if (value) {
+		m_limbs.push_back(value);
+	}
+}
+
+BigInt::BigInt(const std::vector<uint32_t>& limbs) : m_limbs(limbs) {
+	trim();
+}
+
+void BigInt::trim() {
+	while (!m_limbs.empty() && m_limbs.back() == 0) {
+		m_limbs.pop_back();
+	}
+}
+
+BigInt BigInt::fromBytes(const uint8_t* data, size_t length) {
+	BigInt result;
+	result.m_limbs.assign((length + 3) / 4, 0);
+	for (size_t i = 0; i < length; i++) {
+		size_t position = length - 1 - i;
+		result.m_limbs[position / 4] |= (uint32_t)data[i] << (8 * (position % 4));
+	}
+	result.trim();
+	return result;
+}
+
+std::vector<uint8_t> BigInt::toBytes() const {
+	size_t length = std::max<size_t>(1, (bits() + 7) / 8);
+	std::vector<uint8_t> bytes(length);
+	for (size_t i = 0; i < length; i++) {
+		size_t position = length - 1 - i;
+		bytes[i] = position / 4 < m_limbs.size() ? (uint8_t)(m_limbs[position / 4] >> (8 * (position % 4))) : 0;
+	}
+	return bytes;
+}
+
+BigInt BigInt::random(size_t bits) {
+	BigInt result;
+	result.m_limbs.resize((bits + 31) / 32);
+	Random::fill((uint8_t*)result.m_limbs.data(), result.m_limbs.size() * 4);
+	if (bits % 32) {
+		result.m_limbs.back() &= (1u << (bits % 32)) - 1;
+	}
+	result.trim();
+	return result;
+}
+
+const std::vector<uint32_t>& BigInt::limbs() const {
+	return m_limbs;
+}
+
+size_t BigInt::bits() const {
+	if (m_limbs.empty()) {
+		return 0;
+	}
+	size_t count = m_limbs.size() * 32;
+	for (uint32_t top = m_limbs.back(); !(top & 0x80000000u); top <<= 1) {
+		count--;
+	}
+	return count;
+}
+
+bool BigInt::bit(size_t i) const {
+	return i / 32 < m_limbs.size() && (m_limbs[i / 32] >> (i % 32)) & 1;
+}
+
+void BigInt::setBit(size_t i) {
+	if (m_limbs.size() <= i / 32) {
+		m_limbs.resize(i / 32 + 1, 0);
+	}
+	m_limbs[i / 32] |= 1u << (i % 32);
+}
+
+bool BigInt::isZero() const {
+	return m_limbs.empty();
+}
+
+bool BigInt::isOdd() const {
+	return !m_limbs.empty() && (m_limbs[0] & 1);
+}
+
+int BigInt::compare(const BigInt& other) const {
+	if (m_limbs.size() != other.m_limbs.size()) {
+		return m_limbs.size() < other.m_limbs.size() ? -1 : 1;
+	}
+	for (size_t i = m_limbs.size(); i-- > 0;) {
+		if (m_limbs[i] != other.m_limbs[i]) {
+			return m_limbs[i] < other.m_limbs[i] ? -1 : 1;
+		}
+	}
+	return 0;
+}
+
+bool BigInt::operator==(const BigInt& other) const {
+	return m_limbs == other.m_limbs;
+}
+
+bool BigInt::operator!=(const BigInt& other) const {
+	return m_limbs != other.m_limbs;
+}
+
+bool BigInt::operator<(const BigInt& other) const {
+	return compare(other) < 0;
+}
+
+BigInt BigInt::operator+(const BigInt& other) const {
+	const std::vector<uint32_t>& a = m_limbs.size() >= other.m_limbs.size() ? m_limbs : other.m_limbs;
+	const std::vector<uint32_t>& b = m_limbs.size() >= other.m_limbs.size() ? other.m_limbs : m_limbs;
+
+	BigInt result;
+	result.m_limbs.resize(a.size() + 1);
+	uint64_t carry = 0;
+	for (size_t i = 0; i < a.size(); i++) {
+		carry += (uint64_t)a[i] + (i < b.size() ? b[i] : 0);
+		result.m_limbs[i] = (uint32_t)carry;
+		carry >>= 32;
+	}
+	result.m_limbs[a.size()] = (uint32_t)carry;
+	result.trim();
+	return result;
+}
+
+BigInt BigInt::operator-(const BigInt& other) const {
+	BigInt result;
+	result.m_limbs.resize(m_limbs.size());
+	int64_t borrow = 0;
+	for (size_t i = 0; i < m_limbs.size(); i++) {
+		int64_t t = (int64_t)m_limbs[i] - (i < other.m_limbs.size() ? other.m_limbs[i] : 0) - borrow;
+		borrow = t < 0;
+		result.m_limbs[i] = (uint32_t)t;
+	}
+	result.trim();
+	return result;
+}
+
+BigInt BigInt::operator*(const BigInt& other) const {
+	if (isZero() || other.isZero()) {
+		return BigInt();
+	}
+
+	BigInt result;
+	result.m_limbs.assign(m_limbs.size() + other.m_limbs.size(), 0);
+	for (size_t i = 0; i < m_limbs.size(); i++) {
+		uint64_t carry = 0;
+		for (size_t j = 0; j < other.m_limbs.size(); j++) {
+			carry += (uint64_t)m_limbs[i] * other.m_limbs[j] + result.m_limbs[i + j];
+			result.m_limbs[i + j] = (uint32_t)carry;
+			carry >>= 32;
+		}
+		result.m_limbs[i + other.m_limbs.size()] = (uint32_t)carry;
+	}
+	result.trim();
+	return result;
+}
+
+BigInt BigInt::operator/(const BigInt& other) const {
+	BigInt quotient, remainder;
+	divide(*this, other, quotient, remainder);
+	return quotient;
+}
+
+BigInt BigInt::operator%(const BigInt& other) const {
+	BigInt quotient, remainder;
+	divide(*this, other, quotient, remainder);
+	return remainder;
+}
+
+BigInt BigInt::operator<<(size_t shift) const {
+	if (isZero()) {
+		return BigInt();
+	}
+
+	size_t limbs = shift / 32, bits = shift % 32;
+	BigInt result;
+	result.m_limbs.assign(m_limbs.size() + limbs + 1, 0);
+	for (size_t i = 0; i < m_limbs.size(); i++) {
+		result.m_limbs[i + limbs] |= m_limbs[i] << bits;
+		if (bits) {
+			result.m_limbs[i + limbs + 1] = m_limbs[i] >> (32 - bits);
+		}
+	}
+	result.trim();
+	return result;
+}
+
+BigInt BigInt::operator>>(size_t shift) const {
+	size_t limbs = shift / 32, bits = shift % 32;
+	if (limbs >= m_limbs.size()) {
+		return BigInt();
+	}
+
+	BigInt result;
+	result.m_limbs.resize(m_limbs.size() - limbs);
+	for (size_t i = 0; i < result.m_limbs.size(); i++) {
+		result.m_limbs[i] = m_limbs[i + limbs] >> bits;
+		if (bits && i + limbs + 1 < m_limbs.size()) {
+			result.m_limbs[i] |= m_limbs[i + limbs + 1] << (32 - bits);
+		}
+	}
+	result.trim();
+	return result;
+}
+
+uint32_t BigInt::mod(uint32_t m) const {
+	uint64_t remainder = 0;
+	for (size_t i = m_limbs.size(); i-- > 0;) {
+		remainder = ((remainder << 32) | m_limbs[i]) % m;
+	}
+	return (uint32_t)remainder;
+}
+
+void BigInt::divide(const BigInt& a, const BigInt& b, BigInt& quotient, BigInt& remainder) {
+	if (a < b) {
+		quotient = BigInt();
+		remainder = a;
+		return;
+	}
+
+	size_t n = b.m_limbs.size();
+	if (n == 1) {
+		uint32_t d = b.m_limbs[0];
+		uint64_t r = 0;
+		quotient.m_limbs.assign(a.m_limbs.size(), 0);
+		for (size_t i = a.m_limbs.size(); i-- > 0;) {
+			uint64_t current = (r << 32) | a.m_limbs[i];
+			quotient.m_limbs[i] = (uint32_t)(current / d);
+			r = current % d;
+		}
+		quotient.trim();
+		remainder = BigInt((uint32_t)r);
+		return;
+	}
+
+	// Normalise so the divisor's top limb has its high bit set, which keeps each
+	// estimated quotient limb at most two too large
+	size_t shift = 0;
+	for (uint32_t top = b.m_limbs.back(); !(top & 0x80000000u); top <<= 1) {
+		shift++;
+	}
+	std::vector<uint32_t> v = (b << shift).m_limbs;
+	std::vector<uint32_t> u = (a << shift).m_limbs;
+	u.resize(a.m_limbs.size() + 1, 0);
+	size_t m = u.size() - n;
+
+	quotient.m_limbs.assign(m, 0);
+	for (size_t j = m; j-- > 0;) {
+		uint64_t numerator = ((uint64_t)u[j + n] << 32) | u[j + n - 1];
+		uint64_t qhat = numerator / v[n - 1];
+		uint64_t rhat = numerator % v[n - 1];
+		while (qhat >> 32 || qhat * v[n - 2] > ((rhat << 32) | u[j + n - 2])) {
+			qhat--;
+			rhat += v[n - 1];
+			if (rhat >> 32) {
+				break;
+			}
+		}
+
+		int64_t borrow = 0, t;
+		for (size_t i = 0; i < n; i++) {
+			uint64_t product = qhat * v[i];
+			t = (int64_t)u[i + j] - borrow - (int64_t)(product & 0xffffffffu);
+			u[i + j] = (uint32_t)t;
+			borrow = (int64_t)(product >> 32) - (t >> 32);
+		}
+		t = (int64_t)u[j + n] - borrow;
+		u[j + n] = (uint32_t)t;
+
+		quotient.m_limbs[j] = (uint32_t)qhat;
+		if (t < 0) {
+			// Estimate was one too large, add the divisor back
+			quotient.m_limbs[j]--;
+			uint64_t carry = 0;
+			for (size_t i = 0; i < n; i++) {
+				carry += (uint64_t)u[i + j] + v[i];
+				u[i + j] = (uint32_t)carry;
+				carry >>= 32;
+			}
+			u[j + n] += (uint32_t)carry;
+		}
+	}
+	quotient.trim();
+
+	u.resize(n);
+	remainder = BigInt(u) >> shift;
+}
+
+BigInt BigInt::gcd(BigInt a, BigInt b) {
+	while (!b.isZero()) {
+		BigInt r = a % b;
+		a = b;
+		b = r;
+	}
+	return a;
+}
+
+BigInt BigInt::inverse(const BigInt& a, const BigInt& m) {
+	// Extended Euclid keeping the coefficient reduced mod m so it never goes negative
+	BigInt r0 = m, r1 = a % m;
+	BigInt t0, t1(1);
+	while (!r1.isZero()) {
+		BigInt q, r;
+		divide(r0, r1, q, r);
+		r0 = r1;
+		r1 = r;
+
+		BigInt qt = (q * t1) % m;
+		BigInt t = qt.compare(t0) > 0 ? t0 + m - qt : t0 - qt;
+		t0 = t1;
+		t1 = t;
+	}
+	return r0 == BigInt(1) ? t0 : BigInt();
+}
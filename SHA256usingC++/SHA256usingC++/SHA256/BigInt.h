@@ -0,0 +1,61 @@
+#ifndef BIG_INT_H
+#define BIG_INT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Non-negative arbitrary precision integer on 32-bit limbs, least significant first, with
+// no leading zero limbs. Enough arithmetic for RSA key generation; modular exponentiation
+// lives in Montgomery.
+class BigInt {
+
+public:
+	BigInt();
+	BigInt(uint32_t value);
+	explicit BigInt(const std::vector<uint32_t>& limbs);
+
+	// Big endian bytes, as in DER.
+	static BigInt fromBytes(const uint8_t* data, size_t length);
+	// Minimal big endian encoding, a single zero byte for zero.
+	std::vector<uint8_t> toBytes() const;
+
+	// Uniformly random below 2^bits, from Random.
+	static BigInt random(size_t bits);
+
+	const std::vector<uint32_t>& limbs() const;
+	size_t bits() const;
+	bool bit(size_t i) const;
+	void setBit(size_t i);
+	bool isZero() const;
+	bool isOdd() const;
+
+	int compare(const BigInt& other) const;
+	bool operator==(const BigInt& other) const;
+	bool operator!=(const BigInt& other) const;
+	bool operator<(const BigInt& other) const;
+
+	BigInt operator+(const BigInt& other) const;
+	// Requires *this >= other.
+	BigInt operator-(const BigInt& other) const;
+	BigInt operator*(const BigInt& other) const;
+	BigInt operator/(const BigInt& other) const;
+	BigInt operator%(const BigInt& other) const;
+	BigInt operator<<(size_t shift) const;
+	BigInt operator>>(size_t shift) const;
+
+	uint32_t mod(uint32_t m) const;
+
+	// Knuth's algorithm D; divisor must not be zero.
+	static void divide(const BigInt& a, const BigInt& b, BigInt& quotient, BigInt& remainder);
+	static BigInt gcd(BigInt a, BigInt b);
+	// a^-1 mod m, or zero when a and m are not coprime.
+	static BigInt inverse(const BigInt& a, const BigInt& m);
+
+private:
+	std::vector<uint32_t> m_limbs;
+
+	void trim();
+};
+
+#endif
@@ -0,0 +1,143 @@
+#include "Cipher666.h"
+#include "Random.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+// Zero padded decimal forms of 0..65535 would be a 384 KiB table; two digit pairs cover a
+// six digit code with three lookups instead
+static const char PAIRS[201] =
+	"00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+	"40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+	"8081828384858687888990919293949596979899";
+
+Cipher666::Cipher666(const char* matrix, const int32_t* keys) : m_valid(true) {
+	for (size_t i = 0; i < MATRIX; i++) {
+		m_matrix[i] = matrix[i];
+		if (matrix[i] < '0' || matrix[i] > '9') {
+			m_valid = false;
+		}
+	}
+	for (size_t i = 0; i < DIGITS; i++) {
+		if (keys[i] < 0 || keys[i] >= (int32_t)MATRIX) {
+			m_valid = false;
+		}
+		m_positions[i] = (uint8_t)(keys[i] & 0x7f);
+	}
+}
+
+bool Cipher666::valid() const {
+	return m_valid;
+}
+
+bool Cipher666::enabled() const {
+	return m_valid && m_positions[0] != m_positions[1] && m_positions[2] != m_positions[3] && m_positions[4] != m_positions[5];
+}
+
+template <typename Work>
+void Cipher666::split(size_t count, size_t threads, Work work) {
+	size_t workers = std::max<size_t>(1, std::min(threads, count / THREAD_CHUNK));
+	size_t chunk = (count + workers - 1) / workers;
+
+	std::vector<std::thread> pool;
+	for (size_t t = 1; t < workers; t++) {
+		size_t first = t * chunk;
+		pool.emplace_back([=]() { work(first, std::min(count, first + chunk)); });
+	}
+	work(0, std::min(count, chunk));
+	for (auto& t : pool) {
+		t.join();
+	}
+}
+
+template <typename Char>
+size_t Cipher666::encrypt(const uint16_t* text, size_t length, Char* out, size_t threads) const {
+	if (!enabled()) {
+		return 0;
+	}
+
+	Char matrix[MATRIX];
+	for (size_t i = 0; i < MATRIX; i++) {
+		matrix[i] = (Char)m_matrix[i];
+	}
+
+	split(length, threads, [&](size_t first, size_t last) {
+		Char* block = out + first * MATRIX;
+		for (size_t i = first; i < last; i++, block += MATRIX) {
+			memcpy(block, matrix, sizeof(matrix));
+
+			// The first digit is always 0 since codes stop at 65535. Later keys win where
+			// positions repeat, as they did when the app rewrote the string key by key.
+			uint32_t code = text[i];
+			uint32_t high = code / 10000, mid = code / 100 % 100, low = code % 100;
+			block[m_positions[0]] = (Char)'0';
+			block[m_positions[1]] = (Char)PAIRS[high * 2 + 1];
+			block[m_positions[2]] = (Char)PAIRS[mid * 2];
+			block[m_positions[3]] = (Char)PAIRS[mid * 2 + 1];
+			block[m_positions[4]] = (Char)PAIRS[low * 2];
+			block[m_positions[5]] = (Char)PAIRS[low * 2 + 1];
+		}
+	});
+
+	return length;
+}
+
+template <typename Char>
+bool Cipher666::decrypt(const Char* in, size_t count, uint16_t* out, size_t threads) const {
+	if (!m_valid) {
+		return false;
+	}
+
+	std::atomic<bool> ok(true);
+	split(count, threads, [&](size_t first, size_t last) {
+		const Char* block = in + first * MATRIX;
+		bool good = true;
+		for (size_t i = first; i < last; i++, block += MATRIX) {
+			uint32_t code = 0;
+			for (size_t d = 0; d < DIGITS; d++) {
+				uint32_t digit = (uint32_t)block[m_positions[d]] - '0';
+				good &= digit <= 9;
+				code = code * 10 + digit;
+			}
+			good &= code <= 0xffff;
+			out[i] = (uint16_t)code;
+		}
+		if (!good) {
+			ok = false;
+		}
+	});
+
+	return ok;
+}
+
+// Uniform in [low, high) by rejection, so no value is favoured
+static uint32_t uniform(uint32_t low, uint32_t high) {
+	uint32_t range = high - low;
+	uint32_t limit = UINT32_MAX - UINT32_MAX % range;
+	uint32_t r;
+	do {
+		uint8_t bytes[4];
+		Random::fill(bytes, sizeof(bytes));
+		r = ((uint32_t)bytes[0] << 24) | ((uint32_t)bytes[1] << 16) | ((uint32_t)bytes[2] << 8) | bytes[3];
+	} while (r >= limit);
+	return low + r % range;
+}
+
+void Cipher666::generate(char* matrix, int32_t* keys) {
+	for (size_t n = 0; n < MATRIX / DIGITS; n++) {
+		uint32_t value = uniform(100000, 999999);
+		for (size_t d = DIGITS; d > 0; d--, value /= 10) {
+			matrix[n * DIGITS + d - 1] = (char)('0' + value % 10);
+		}
+	}
+	for (size_t k = 0; k < KEYS; k++) {
+		keys[k] = (int32_t)uniform(10, 99);
+	}
+}
+
+template size_t Cipher666::encrypt<char>(const uint16_t*, size_t, char*, size_t) const;
+template size_t Cipher666::encrypt<uint16_t>(const uint16_t*, size_t, uint16_t*, size_t) const;
+template bool Cipher666::decrypt<char>(const char*, size_t, uint16_t*, size_t) const;
+template bool Cipher666::decrypt<uint16_t>(const uint16_t*, size_t, uint16_t*, size_t) const;
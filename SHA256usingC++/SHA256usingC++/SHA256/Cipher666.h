@@ -0,0 +1,56 @@
+#ifndef CIPHER666_H
+#define CIPHER666_H
+
+#include <cstddef>
+#include <cstdint>
+
+// The matrix cipher of 666_app. The matrix is 108 decimal digits (18 six digit numbers); every
+// character of the text becomes one copy of it, with the character's code zero padded to six
+// digits and written at the positions given by the first six keys. Keys 7 to 18 are drawn and
+// shown by the app but take no part.
+//
+// Each output block depends only on the matrix and its own character, so the text is encoded
+// straight into the output buffer, and long texts are split across threads.
+class Cipher666 {
+
+public:
+	static constexpr size_t MATRIX = 108;
+	static constexpr size_t KEYS = 18;
+	static constexpr size_t DIGITS = 6;
+
+	// matrix: MATRIX ASCII digits. keys: KEYS values, the first DIGITS of which must be positions
+	// inside the matrix; valid() is false otherwise.
+	Cipher666(const char* matrix, const int32_t* keys);
+
+	bool valid() const;
+
+	// Like the app, nothing is encoded unless key 1 != key 2, key 3 != key 4 and key 5 != key 6.
+	bool enabled() const;
+
+	// Writes MATRIX characters per input character to out (room for length * MATRIX) and
+	// returns the number of blocks written: length, or 0 when the cipher is not enabled.
+	template <typename Char>
+	size_t encrypt(const uint16_t* text, size_t length, Char* out, size_t threads) const;
+
+	// Reads count blocks back into count characters. Returns false if a block does not hold a
+	// six digit code of at most 65535 at the key positions.
+	template <typename Char>
+	bool decrypt(const Char* in, size_t count, uint16_t* out, size_t threads) const;
+
+	// A fresh matrix (18 numbers in [100000, 999999)) and keys (in [10, 99)), the ranges the app
+	// has always drawn from, taken from Random.
+	static void generate(char* matrix, int32_t* keys);
+
+private:
+	char m_matrix[MATRIX];
+	uint8_t m_positions[DIGITS];
+	bool m_valid;
+
+	// Blocks below this many characters are not worth a thread
+	static constexpr size_t THREAD_CHUNK = 16384;
+
+	template <typename Work>
+	static void split(size_t count, size_t threads, Work work);
+};
+
+#endif
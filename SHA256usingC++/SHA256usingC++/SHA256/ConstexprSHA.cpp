@@ -0,0 +1,8 @@
+#include "ConstexprSHA.h"
+
+// Known-answer checks from FIPS 180-4, evaluated by the compiler.
+static_assert(ConstexprSHA::sha256("abc") == ConstexprSHA::fromHex("ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad"), "SHA-256 abc");
+static_assert(ConstexprSHA::sha256("abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq") == ConstexprSHA::fromHex("248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1"), "SHA-256 two blocks");
+static_assert(ConstexprSHA::sha512("abc") == ConstexprSHA::fromHex("ddaf35a193617abacc417349ae20413112e6fa4e89a97ea20a9eeee64b55d39a2192992a274fc1a836ba3c23a3feebbd454d4423643ce80e2a9ac94fa54ca49f"), "SHA-512 abc");
+static_assert(ConstexprSHA::sha512("abcdefghbcdefghicdefghijdefghijkefghijklfghijklmghijklmnhijklmnoijklmnopjklmnopqklmnopqrlmnopqrsmnopqrstnopqrstu") == ConstexprSHA::fromHex("8e959b75dae313da8cf4f72814fc143f8f7779c6eb9f7fa17299aeadb6889018501d289e4900f7e4331b99dec4b5433ac7d329eeb6dd26545e96e55b874be909"), "SHA-512 two blocks");
+static_assert(ConstexprSHA::sha256("abcdefghbcdefghicdefghijdefghijkefghijklfghijklmghijklmnhijklmnoijklmnopjklmnopqklmnopqrlmnopqrsmnopqrstnopqrstu") == ConstexprSHA::fromHex("cf5b16a778af8380036ce59e7b0492370b249b11e8f07a51afac45037afee9d1"), "SHA-256 whole block then tail");
@@ -0,0 +1,93 @@
+#ifndef CONSTEXPR_SHA_H
+#define CONSTEXPR_SHA_H
+
+#include <cstddef>
+#include <cstdint>
+#include "SHA256.h"
+#include "SHA512.h"
+
+// Digest bytes that can live in a constexpr variable and be compared in a static_assert.
+template <size_t N>
+struct StaticDigest {
+	uint8_t bytes[N];
+
+	constexpr bool operator==(const StaticDigest& other) const {
+		for (size_t i = 0; i < N; i++) {
+			if (bytes[i] != other.bytes[i]) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	constexpr bool operator!=(const StaticDigest& other) const {
+		return !(*this == other);
+	}
+};
+
+// SHA-256 and SHA-512 of literals at compile time, so their digests are baked into the binary
+// instead of being computed at startup:
+//
+//   constexpr auto d = ConstexprSHA::sha256("abc");
+//   static_assert(d == ConstexprSHA::fromHex("ba7816bf..."), "");
+//
+// This runs the SHA256 and SHA512 classes themselves, whose cores are constexpr; it only feeds
+// them bytes, since a literal's chars cannot be reinterpreted as uint8_t in a constant expression.
+class ConstexprSHA {
+
+public:
+	template <size_t N>
+	static constexpr StaticDigest<SHA256::SIZE> sha256(const char (&literal)[N]) {
+		return hash<SHA256>(literal, N - 1);
+	}
+
+	template <typename Byte>
+	static constexpr StaticDigest<SHA256::SIZE> sha256(const Byte* data, size_t length) {
+		return hash<SHA256>(data, length);
+	}
+
+	template <size_t N>
+	static constexpr StaticDigest<SHA512::SIZE> sha512(const char (&literal)[N]) {
+		return hash<SHA512>(literal, N - 1);
+	}
+
+	template <typename Byte>
+	static constexpr StaticDigest<SHA512::SIZE> sha512(const Byte* data, size_t length) {
+		return hash<SHA512>(data, length);
+	}
+
+	// Parses a hex digest literal, for comparisons in static_assert.
+	template <size_t N>
+	static constexpr StaticDigest<(N - 1) / 2> fromHex(const char (&hex)[N]) {
+		StaticDigest<(N - 1) / 2> digest = {};
+		for (size_t i = 0; i < (N - 1) / 2; i++) {
+			digest.bytes[i] = (uint8_t)((nibble(hex[i * 2]) << 4) | nibble(hex[i * 2 + 1]));
+		}
+		return digest;
+	}
+
+private:
+	template <typename Hash, typename Byte>
+	static constexpr StaticDigest<Hash::SIZE> hash(const Byte* data, size_t length) {
+		Hash sha;
+		uint8_t block[Hash::BLOCK] = {};
+		for (size_t done = 0; done < length; ) {
+			size_t take = length - done < Hash::BLOCK ? length - done : Hash::BLOCK;
+			for (size_t i = 0; i < take; i++) {
+				block[i] = static_cast<uint8_t>(data[done + i]);
+			}
+			sha.update(block, take);
+			done += take;
+		}
+
+		StaticDigest<Hash::SIZE> digest = {};
+		sha.digest(digest.bytes);
+		return digest;
+	}
+
+	static constexpr uint8_t nibble(char c) {
+		return c >= 'a' ? c - 'a' + 10 : c >= 'A' ? c - 'A' + 10 : c - '0';
+	}
+};
+
+#endif
@@ -0,0 +1,235 @@
+#include "Container.h"
+#include "GCM.h"
+#include "HMAC.h"
+#include "MappedFile.h"
+#include "Random.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+
+static const uint8_t MAGIC[4] = { 'S', 'E', 'G', '1' };
+
+static inline void store32(uint8_t* p, uint32_t v) {
+	for (uint8_t i = 0; i < 4; i++) {
+		p[i] = (uint8_t)(v >> (24 - 8 * i));
+	}
+}
+
+static inline void store64(uint8_t* p, uint64_t v) {
+	for (uint8_t i = 0; i < 8; i++) {
+		p[i] = (uint8_t)(v >> (56 - 8 * i));
+	}
+}
+
+static inline uint32_t load32(const uint8_t* p) {
+	return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+static inline uint64_t load64(const uint8_t* p) {
+	return ((uint64_t)load32(p) << 32) | load32(p + 4);
+}
+
+static void wipe(uint8_t* data, size_t length) {
+	volatile uint8_t* p = data;
+	for (size_t i = 0; i < length; i++) {
+		p[i] = 0;
+	}
+}
+
+Container::Container(const uint8_t* key, size_t length, size_t threads) : m_key(key, key + length), m_threads(threads ? threads : 1) {
+}
+
+Container::~Container() {
+	wipe(m_key.data(), m_key.size());
+}
+
+void Container::deriveKey(const uint8_t* nonce, uint8_t label, uint8_t* key) const {
+	HMAC hmac(m_key.data(), m_key.size());
+	hmac.update(nonce, 16);
+	hmac.update(&label, 1);
+	hmac.digest(key);
+}
+
+uint64_t Container::segmentCount(uint64_t length, uint32_t segmentSize) {
+	// An empty file still gets one (empty) segment so it carries a tag
+	return length == 0 ? 1 : (length + segmentSize - 1) / segmentSize;
+}
+
+void Container::segmentNonce(uint64_t index, uint8_t* iv) {
+	memset(iv, 0, 4);
+	store64(iv + 4, index);
+}
+
+template <typename Work>
+bool Container::parallel(uint64_t first, uint64_t count, Work work) const {
+	std::atomic<uint64_t> next(first);
+	std::atomic<bool> ok(true);
+	uint64_t end = first + count;
+
+	auto worker = [&]() {
+		uint64_t i;
+		while (ok && (i = next++) < end) {
+			if (!work(i)) {
+				ok = false;
+			}
+		}
+	};
+
+	size_t workers = (size_t)std::min<uint64_t>(m_threads, count);
+	std::vector<std::thread> threads;
+	for (size_t t = 1; t < workers; t++) {
+		threads.emplace_back(worker);
+	}
+	worker();
+	for (auto& t : threads) {
+		t.join();
+	}
+
+	return ok;
+}
+
+bool Container::parseHeader(const uint8_t* data, uint64_t size, Header& header) const {
+	if (size < HEADER_SIZE || memcmp(data, MAGIC, sizeof(MAGIC)) != 0) {
+		return false;
+	}
+
+	header.segmentSize = load32(data + 4);
+	header.length = load64(data + 8);
+	if (header.segmentSize == 0) {
+		return false;
+	}
+	header.segments = segmentCount(header.length, header.segmentSize);
+
+	uint8_t macKey[32], mac[32];
+	deriveKey(data + 16, 0x02, macKey);
+	HMAC::mac(macKey, sizeof(macKey), data, 32, mac);
+	wipe(macKey, sizeof(macKey));
+
+	uint8_t diff = 0;
+	for (uint8_t i = 0; i < 32; i++) {
+		diff |= mac[i] ^ data[32 + i];
+	}
+	if (diff != 0 || size != HEADER_SIZE + header.length + header.segments * TAG_SIZE) {
+		return false;
+	}
+
+	deriveKey(data + 16, 0x01, header.encryptionKey);
+	return true;
+}
+
+bool Container::seal(const std::string& in, const std::string& out, uint32_t segmentSize) {
+	MappedFile input, output;
+	if (segmentSize == 0 || !input.open(in, false)) {
+		return false;
+	}
+
+	uint64_t length = input.size();
+	uint64_t segments = segmentCount(length, segmentSize);
+	if (!output.create(out, HEADER_SIZE + length + segments * TAG_SIZE)) {
+		return false;
+	}
+
+	uint8_t* header = output.data();
+	memcpy(header, MAGIC, sizeof(MAGIC));
+	store32(header + 4, segmentSize);
+	store64(header + 8, length);
+
+	Random::fill(header + 16, 16);
+
+	uint8_t key[32];
+	deriveKey(header + 16, 0x02, key);
+	HMAC::mac(key, sizeof(key), header, 32, header + 32);
+	deriveKey(header + 16, 0x01, key);
+	GCM gcm(key, sizeof(key));
+	wipe(key, sizeof(key));
+
+	parallel(0, segments, [&](uint64_t i) {
+		uint64_t start = i * segmentSize;
+		size_t size = (size_t)std::min<uint64_t>(segmentSize, length - start);
+		uint8_t* sealed = header + HEADER_SIZE + i * ((uint64_t)segmentSize + TAG_SIZE);
+		uint8_t iv[GCM::IV_SIZE];
+		segmentNonce(i, iv);
+
+		gcm.seal(iv, header, HEADER_SIZE, input.data() + start, size, sealed, sealed + size);
+		return true;
+	});
+
+	output.sync();
+	return true;
+}
+
+bool Container::open(const std::string& in, const std::string& out) {
+	MappedFile input, output;
+	Header header;
+	if (!input.open(in, false) || !parseHeader(input.data(), input.size(), header)) {
+		return false;
+	}
+	GCM gcm(header.encryptionKey, sizeof(header.encryptionKey));
+	wipe(header.encryptionKey, sizeof(header.encryptionKey));
+
+	if (!output.create(out, header.length)) {
+		return false;
+	}
+
+	bool ok = parallel(0, header.segments, [&](uint64_t i) {
+		uint64_t start = i * header.segmentSize;
+		size_t size = (size_t)std::min<uint64_t>(header.segmentSize, header.length - start);
+		const uint8_t* sealed = input.data() + HEADER_SIZE + i * ((uint64_t)header.segmentSize + TAG_SIZE);
+		uint8_t iv[GCM::IV_SIZE];
+		segmentNonce(i, iv);
+
+		return gcm.open(iv, input.data(), HEADER_SIZE, sealed, size, sealed + size, output.data() + start);
+	});
+
+	if (!ok) {
+		output.close();
+		std::remove(out.c_str());
+		return false;
+	}
+
+	output.sync();
+	return true;
+}
+
+bool Container::read(const std::string& in, uint64_t offset, size_t length, uint8_t* out) {
+	MappedFile input;
+	Header header;
+	if (!input.open(in, false) || !parseHeader(input.data(), input.size(), header)) {
+		return false;
+	}
+	if (offset > header.length || length > header.length - offset) {
+		wipe(header.encryptionKey, sizeof(header.encryptionKey));
+		return false;
+	}
+	GCM gcm(header.encryptionKey, sizeof(header.encryptionKey));
+	wipe(header.encryptionKey, sizeof(header.encryptionKey));
+
+	if (length == 0) {
+		return true;
+	}
+
+	// Only the segments overlapping the range are authenticated and decrypted
+	uint64_t first = offset / header.segmentSize;
+	uint64_t last = (offset + length - 1) / header.segmentSize;
+
+	return parallel(first, last - first + 1, [&](uint64_t i) {
+		uint64_t start = i * header.segmentSize;
+		size_t size = (size_t)std::min<uint64_t>(header.segmentSize, header.length - start);
+		const uint8_t* sealed = input.data() + HEADER_SIZE + i * ((uint64_t)header.segmentSize + TAG_SIZE);
+		uint8_t iv[GCM::IV_SIZE];
+		segmentNonce(i, iv);
+
+		std::vector<uint8_t> plain(size);
+		if (!gcm.open(iv, input.data(), HEADER_SIZE, sealed, size, sealed + size, plain.data())) {
+			return false;
+		}
+
+		uint64_t from = std::max(start, offset);
+		uint64_t to = std::min<uint64_t>(start + size, offset + length);
+		memcpy(out + (from - offset), plain.data() + (from - start), (size_t)(to - from));
+		wipe(plain.data(), plain.size());
+		return true;
+	});
+}
@@ -0,0 +1,65 @@
+#ifndef CONTAINER_H
+#define CONTAINER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Seekable authenticated encryption of whole files.
+//
+// The plaintext is cut into fixed-size segments and each one is sealed on its own with
+// AES-256-GCM, so segments are encrypted and decrypted in parallel and any byte range can
+// be read by opening only the segments that cover it. Layout:
+//
+//   0   "SEG1"
+//   4   segment size, big endian u32
+//   8   plaintext length, big endian u64
+//   16  16 byte random file nonce
+//   32  HMAC-SHA256 of bytes 0..31
+//   64  segment i: ciphertext || 16 byte tag, at 64 + i * (segment size + 16)
+//
+// The encryption and header MAC keys are HMAC(master key, file nonce || 1) and || 2, so
+// every file has fresh keys and segment i can use the plain nonce 0^32 || i. Each segment
+// authenticates the whole header as AAD, which ties it to its file and to the declared
+// length; a truncated or spliced file fails to open.
+class Container {
+
+public:
+	static constexpr size_t HEADER_SIZE = 64;
+	static constexpr size_t TAG_SIZE = 16;
+	static constexpr uint32_t DEFAULT_SEGMENT = 1 << 20;
+
+	Container(const uint8_t* key, size_t length, size_t threads);
+	~Container();
+
+	bool seal(const std::string& in, const std::string& out, uint32_t segmentSize = DEFAULT_SEGMENT);
+	// Fails without leaving out behind if any segment does not authenticate.
+	bool open(const std::string& in, const std::string& out);
+	// Decrypts length bytes at offset into out, returns false if the range is past the end
+	// or a covering segment does not authenticate.
+	bool read(const std::string& in, uint64_t offset, size_t length, uint8_t* out);
+
+private:
+	struct Header {
+		uint32_t segmentSize;
+		uint64_t length;
+		uint64_t segments;
+		uint8_t encryptionKey[32];
+	};
+
+	std::vector<uint8_t> m_key;
+	size_t m_threads;
+
+	void deriveKey(const uint8_t* nonce, uint8_t label, uint8_t* key) const;
+	bool parseHeader(const uint8_t* data, uint64_t size, Header& header) const;
+	static uint64_t segmentCount(uint64_t length, uint32_t segmentSize);
+	static void segmentNonce(uint64_t index, uint8_t* iv);
+
+	// Runs work(i) for i in [first, first + count) on the worker threads, stops early and
+	// returns false once any call fails.
+	template <typename Work>
+	bool parallel(uint64_t first, uint64_t count, Work work) const;
+};
+
+#endif
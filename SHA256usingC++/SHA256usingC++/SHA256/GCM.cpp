@@ -0,0 +1,248 @@
+#include "GCM.h"
+#include <cstring>
+
+#ifdef AES_HARDWARE
+#include <immintrin.h>
+#include <wmmintrin.h>
+#endif
+
+static inline uint64_t load64(const uint8_t* p) {
+	uint64_t v = 0;
+	for (uint8_t i = 0; i < 8; i++) {
+		v = (v << 8) | p[i];
+	}
+	return v;
+}
+
+static inline void store64(uint8_t* p, uint64_t v) {
+	for (uint8_t i = 0; i < 8; i++) {
+		p[i] = (uint8_t)(v >> (56 - 8 * i));
+	}
+}
+
+GCM::GCM(const uint8_t* key, size_t length) : m_aes(key, length), m_hardware(AES::accelerated()) {
+	uint8_t zero[16] = { 0 };
+	m_aes.encryptBlock(zero, m_h);
+	memset(m_powers, 0, sizeof(m_powers));
+#ifdef AES_HARDWARE
+	if (m_hardware) {
+		initHardware();
+	}
+#endif
+}
+
+bool GCM::valid() const {
+	return m_aes.valid();
+}
+
+GCM::~GCM() {
+	volatile uint8_t* h = m_h;
+	for (size_t i = 0; i < sizeof(m_h); i++) {
+		h[i] = 0;
+	}
+	volatile uint8_t* powers = &m_powers[0][0];
+	for (size_t i = 0; i < sizeof(m_powers); i++) {
+		powers[i] = 0;
+	}
+}
+
+void GCM::seal(const uint8_t* iv, const uint8_t* aad, size_t aadLength,
+	const uint8_t* in, size_t length, uint8_t* out, uint8_t* tag) const {
+	// Data is encrypted from counter 2; counter 1 masks the tag
+	uint8_t counter[16];
+	memcpy(counter, iv, IV_SIZE);
+	counter[12] = counter[13] = counter[14] = 0;
+	counter[15] = 2;
+	m_aes.ctr(counter, in, out, length);
+
+	uint8_t x[16] = { 0 };
+	ghash(x, aad, aadLength);
+	ghash(x, out, length);
+	finish(iv, x, aadLength, length, tag);
+}
+
+bool GCM::open(const uint8_t* iv, const uint8_t* aad, size_t aadLength,
+	const uint8_t* in, size_t length, const uint8_t* tag, uint8_t* out) const {
+	uint8_t x[16] = { 0 };
+	uint8_t expected[TAG_SIZE];
+	ghash(x, aad, aadLength);
+	ghash(x, in, length);
+	finish(iv, x, aadLength, length, expected);
+
+	uint8_t diff = 0;
+	for (size_t i = 0; i < TAG_SIZE; i++) {
+		diff |= expected[i] ^ tag[i];
+	}
+	if (diff != 0) {
+		memset(out, 0, length);
+		return false;
+	}
+
+	uint8_t counter[16];
+	memcpy(counter, iv, IV_SIZE);
+	counter[12] = counter[13] = counter[14] = 0;
+	counter[15] = 2;
+	m_aes.ctr(counter, in, out, length);
+	return true;
+}
+
+void GCM::finish(const uint8_t* iv, uint8_t* x, size_t aadLength, size_t length, uint8_t* tag) const {
+	uint8_t lengths[16];
+	store64(lengths, (uint64_t)aadLength * 8);
+	store64(lengths + 8, (uint64_t)length * 8);
+	ghash(x, lengths, 16);
+
+	uint8_t j0[16];
+	memcpy(j0, iv, IV_SIZE);
+	j0[12] = j0[13] = j0[14] = 0;
+	j0[15] = 1;
+	m_aes.encryptBlock(j0, tag);
+	for (uint8_t i = 0; i < 16; i++) {
+		tag[i] ^= x[i];
+	}
+}
+
+void GCM::ghash(uint8_t* x, const uint8_t* data, size_t length) const {
+	size_t blocks = length / 16;
+
+#ifdef AES_HARDWARE
+	if (m_hardware) {
+		ghashHardware(x, data, blocks);
+	}
+	else
+#endif
+	{
+		for (size_t b = 0; b < blocks; b++) {
+			for (uint8_t i = 0; i < 16; i++) {
+				x[i] ^= data[b * 16 + i];
+			}
+			multiplyPortable(x, m_h);
+		}
+	}
+
+	// The last partial block is zero padded
+	size_t rest = length % 16;
+	if (rest) {
+		uint8_t last[16] = { 0 };
+		memcpy(last, data + blocks * 16, rest);
+#ifdef AES_HARDWARE
+		if (m_hardware) {
+			ghashHardware(x, last, 1);
+			return;
+		}
+#endif
+		for (uint8_t i = 0; i < 16; i++) {
+			x[i] ^= last[i];
+		}
+		multiplyPortable(x, m_h);
+	}
+}
+
+void GCM::multiplyPortable(uint8_t* x, const uint8_t* h) {
+	// Shift-and-add over the bits of x, most significant first. Every step does the same
+	// work and selects with masks, so neither x nor H shows up in the timing.
+	uint64_t xHi = load64(x), xLo = load64(x + 8);
+	uint64_t vHi = load64(h), vLo = load64(h + 8);
+	uint64_t zHi = 0, zLo = 0;
+
+	for (size_t i = 0; i < 128; i++) {
+		uint64_t bit = i < 64 ? xHi >> (63 - i) : xLo >> (127 - i);
+		uint64_t mask = 0 - (bit & 1);
+		zHi ^= vHi & mask;
+		zLo ^= vLo & mask;
+
+		uint64_t reduce = 0 - (vLo & 1);
+		vLo = (vLo >> 1) | (vHi << 63);
+		vHi = (vHi >> 1) ^ (0xe100000000000000ULL & reduce);
+	}
+
+	store64(x, zHi);
+	store64(x + 8, zLo);
+}
+
+#ifdef AES_HARDWARE
+
+// 256-bit carry-less product of a and b, both in the bit reflected byte order
+static inline AES_HARDWARE_TARGET void clmul(__m128i a, __m128i b, __m128i& lo, __m128i& hi) {
+	__m128i mid = _mm_xor_si128(_mm_clmulepi64_si128(a, b, 0x10), _mm_clmulepi64_si128(a, b, 0x01));
+	lo = _mm_xor_si128(_mm_clmulepi64_si128(a, b, 0x00), _mm_slli_si128(mid, 8));
+	hi = _mm_xor_si128(_mm_clmulepi64_si128(a, b, 0x11), _mm_srli_si128(mid, 8));
+}
+
+// Shifts the product left by one for the reflected representation and reduces it modulo
+// x^128 + x^7 + x^2 + x + 1 (Intel carry-less multiplication white paper, algorithm 5)
+static inline AES_HARDWARE_TARGET __m128i reduce(__m128i lo, __m128i hi) {
+	__m128i carryLo = _mm_srli_epi32(lo, 31);
+	__m128i carryHi = _mm_srli_epi32(hi, 31);
+	lo = _mm_slli_epi32(lo, 1);
+	hi = _mm_slli_epi32(hi, 1);
+	__m128i across = _mm_srli_si128(carryLo, 12);
+	carryHi = _mm_slli_si128(carryHi, 4);
+	carryLo = _mm_slli_si128(carryLo, 4);
+	lo = _mm_or_si128(lo, carryLo);
+	hi = _mm_or_si128(_mm_or_si128(hi, carryHi), across);
+
+	__m128i a = _mm_xor_si128(_mm_xor_si128(_mm_slli_epi32(lo, 31), _mm_slli_epi32(lo, 30)), _mm_slli_epi32(lo, 25));
+	__m128i b = _mm_srli_si128(a, 4);
+	lo = _mm_xor_si128(lo, _mm_slli_si128(a, 12));
+
+	__m128i c = _mm_xor_si128(_mm_xor_si128(_mm_srli_epi32(lo, 1), _mm_srli_epi32(lo, 2)), _mm_srli_epi32(lo, 7));
+	lo = _mm_xor_si128(lo, _mm_xor_si128(c, b));
+	return _mm_xor_si128(hi, lo);
+}
+
+static inline AES_HARDWARE_TARGET __m128i byteSwap(__m128i x) {
+	return _mm_shuffle_epi8(x, _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15));
+}
+
+void GCM::initHardware() {
+	__m128i h = byteSwap(_mm_loadu_si128((const __m128i*)m_h));
+	__m128i power = h;
+	for (int i = 0; i < 4; i++) {
+		_mm_store_si128((__m128i*)m_powers[i], power);
+		__m128i lo, hi;
+		clmul(power, h, lo, hi);
+		power = reduce(lo, hi);
+	}
+}
+
+void GCM::ghashHardware(uint8_t* x, const uint8_t* data, size_t blocks) const {
+	__m128i h1 = _mm_load_si128((const __m128i*)m_powers[0]);
+	__m128i h2 = _mm_load_si128((const __m128i*)m_powers[1]);
+	__m128i h3 = _mm_load_si128((const __m128i*)m_powers[2]);
+	__m128i h4 = _mm_load_si128((const __m128i*)m_powers[3]);
+	__m128i y = byteSwap(_mm_loadu_si128((const __m128i*)x));
+
+	// Four blocks at a time: (Y ^ C1)H^4 ^ C2 H^3 ^ C3 H^2 ^ C4 H with a single reduction
+	size_t b = 0;
+	for (; b + 4 <= blocks; b += 4) {
+		__m128i c1 = _mm_xor_si128(y, byteSwap(_mm_loadu_si128((const __m128i*)(data + b * 16))));
+		__m128i c2 = byteSwap(_mm_loadu_si128((const __m128i*)(data + b * 16 + 16)));
+		__m128i c3 = byteSwap(_mm_loadu_si128((const __m128i*)(data + b * 16 + 32)));
+		__m128i c4 = byteSwap(_mm_loadu_si128((const __m128i*)(data + b * 16 + 48)));
+
+		__m128i lo, hi, l, h;
+		clmul(c1, h4, lo, hi);
+		clmul(c2, h3, l, h);
+		lo = _mm_xor_si128(lo, l);
+		hi = _mm_xor_si128(hi, h);
+		clmul(c3, h2, l, h);
+		lo = _mm_xor_si128(lo, l);
+		hi = _mm_xor_si128(hi, h);
+		clmul(c4, h1, l, h);
+		lo = _mm_xor_si128(lo, l);
+		hi = _mm_xor_si128(hi, h);
+		y = reduce(lo, hi);
+	}
+
+	for (; b < blocks; b++) {
+		y = _mm_xor_si128(y, byteSwap(_mm_loadu_si128((const __m128i*)(data + b * 16))));
+		__m128i lo, hi;
+		clmul(y, h1, lo, hi);
+		y = reduce(lo, hi);
+	}
+
+	_mm_storeu_si128((__m128i*)x, byteSwap(y));
+}
+
+#endif
@@ -0,0 +1,45 @@
+#ifndef GCM_H
+#define GCM_H
+
+#include <cstddef>
+#include <cstdint>
+#include "AES.h"
+
+// AES-GCM (NIST SP 800-38D) with 96-bit IVs and 128-bit tags.
+// GHASH runs on PCLMULQDQ when available, otherwise on a constant-time shift-and-add multiply.
+class GCM {
+
+public:
+	static constexpr size_t IV_SIZE = 12;
+	static constexpr size_t TAG_SIZE = 16;
+
+	// 16, 24 or 32 byte AES keys; see AES::valid().
+	GCM(const uint8_t* key, size_t length);
+	~GCM();
+
+	bool valid() const;
+
+	void seal(const uint8_t* iv, const uint8_t* aad, size_t aadLength,
+		const uint8_t* in, size_t length, uint8_t* out, uint8_t* tag) const;
+
+	// Returns false and zeroes out if the tag does not match.
+	bool open(const uint8_t* iv, const uint8_t* aad, size_t aadLength,
+		const uint8_t* in, size_t length, const uint8_t* tag, uint8_t* out) const;
+
+private:
+	AES m_aes;
+	bool m_hardware;
+	// Hash key H, and for the carry-less path H^1..H^4 byte reversed so four blocks share a reduction
+	uint8_t m_h[16];
+	alignas(16) uint8_t m_powers[4][16];
+
+	void ghash(uint8_t* x, const uint8_t* data, size_t length) const;
+	void finish(const uint8_t* iv, uint8_t* x, size_t aadLength, size_t length, uint8_t* tag) const;
+	static void multiplyPortable(uint8_t* x, const uint8_t* h);
+#ifdef AES_HARDWARE
+	AES_HARDWARE_TARGET void initHardware();
+	AES_HARDWARE_TARGET void ghashHardware(uint8_t* x, const uint8_t* data, size_t blocks) const;
+#endif
+};
+
+#endif
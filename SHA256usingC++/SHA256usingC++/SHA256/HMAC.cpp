@@ -0,0 +1,241 @@
+#include "HMAC.h"
+#include "SHA1Batch.h"
+#include <cstring>
+
+template <typename Hash>
+BasicHMAC<Hash>::BasicHMAC(const uint8_t* key, size_t length) {
+	uint8_t block[Hash::BLOCK] = { 0 };
+	if (length > Hash::BLOCK) {
+		Hash hash;
+		hash.update(key, length);
+		hash.digest(block);
+	}
+	else {
+		memcpy(block, key, length);
+	}
+
+	uint8_t pad[Hash::BLOCK];
+	for (size_t i = 0; i < Hash::BLOCK; i++) {
+		pad[i] = block[i] ^ 0x36;
+	}
+	m_innerKey.update(pad, Hash::BLOCK);
+	for (size_t i = 0; i < Hash::BLOCK; i++) {
+		pad[i] = block[i] ^ 0x5c;
+	}
+	m_outerKey.update(pad, Hash::BLOCK);
+	m_inner = m_innerKey;
+
+	volatile uint8_t* p = block;
+	for (size_t i = 0; i < Hash::BLOCK; i++) {
+		p[i] = 0;
+	}
+}
+
+template <typename Hash>
+void BasicHMAC<Hash>::update(const uint8_t* data, size_t length) {
+	m_inner.update(data, length);
+}
+
+template <typename Hash>
+void BasicHMAC<Hash>::digest(uint8_t* mac) {
+	uint8_t inner[SIZE];
+	m_inner.digest(inner);
+
+	Hash outer = m_outerKey;
+	outer.update(inner, SIZE);
+	outer.digest(mac);
+	m_inner = m_innerKey;
+}
+
+template <typename Hash>
+void BasicHMAC<Hash>::mac(const uint8_t* key, size_t keyLength, const uint8_t* data, size_t length, uint8_t* out) {
+	BasicHMAC hmac(key, keyLength);
+	hmac.update(data, length);
+	hmac.digest(out);
+}
+
+template <typename Hash>
+void BasicHMAC<Hash>::pbkdf2(const uint8_t* password, size_t passwordLength, const uint8_t* salt, size_t saltLength,
+	uint32_t iterations, uint8_t* out, size_t length) {
+	BasicHMAC prf(password, passwordLength);
+	uint8_t u[SIZE], t[SIZE];
+
+	for (uint32_t block = 1; length > 0; block++) {
+		uint8_t index[4] = { (uint8_t)(block >> 24), (uint8_t)(block >> 16), (uint8_t)(block >> 8), (uint8_t)block };
+		prf.update(salt, saltLength);
+		prf.update(index, 4);
+		prf.digest(u);
+		memcpy(t, u, SIZE);
+
+		for (uint32_t i = 1; i < iterations; i++) {
+			prf.update(u, SIZE);
+			prf.digest(u);
+			for (size_t j = 0; j < SIZE; j++) {
+				t[j] ^= u[j];
+			}
+		}
+
+		size_t take = length < SIZE ? length : SIZE;
+		memcpy(out, t, take);
+		out += take;
+		length -= take;
+	}
+
+	volatile uint8_t* p = u;
+	for (size_t i = 0; i < SIZE; i++) {
+		p[i] = 0;
+	}
+	p = t;
+	for (size_t i = 0; i < SIZE; i++) {
+		p[i] = 0;
+	}
+}
+
+// Every PBKDF2-HMAC-SHA1 iteration hashes a 20 byte value under the two keyed states, so both
+// compressions are a single block whose padding never changes: 20 bytes of data, 0x80, and
+// the 84 byte (64 + 20) message length. The blocks are laid out once and only the digest
+// words are rewritten. Independent output blocks run side by side in SHA1Batch lanes when there
+// are enough of them; with SHA-NI, or only a few blocks, one chain at a time is faster.
+static void pbkdf2ChainsScalar(const uint32_t* inner, const uint32_t* outer, uint32_t u[5][SHA1Batch::LANES],
+	uint32_t t[5][SHA1Batch::LANES], size_t lanes, uint32_t iterations) {
+	uint8_t block[2][64] = { { 0 } };
+	for (uint8_t b = 0; b < 2; b++) {
+		block[b][20] = 0x80;
+		block[b][62] = 0x02;
+		block[b][63] = 0xa0;
+	}
+
+	for (size_t l = 0; l < lanes; l++) {
+		uint32_t state[5];
+		for (uint8_t i = 0; i < 5; i++) {
+			state[i] = u[i][l];
+		}
+
+		for (uint32_t n = 1; n < iterations; n++) {
+			for (uint8_t b = 0; b < 2; b++) {
+				for (uint8_t i = 0; i < 5; i++) {
+					block[b][i * 4] = (uint8_t)(state[i] >> 24);
+					block[b][i * 4 + 1] = (uint8_t)(state[i] >> 16);
+					block[b][i * 4 + 2] = (uint8_t)(state[i] >> 8);
+					block[b][i * 4 + 3] = (uint8_t)state[i];
+				}
+				memcpy(state, b == 0 ? inner : outer, sizeof(state));
+				SHA1::compress(state, block[b], 1);
+			}
+			for (uint8_t i = 0; i < 5; i++) {
+				t[i][l] ^= state[i];
+			}
+		}
+
+		volatile uint32_t* p = state;
+		for (uint8_t i = 0; i < 5; i++) {
+			p[i] = 0;
+		}
+	}
+
+	volatile uint8_t* p = &block[0][0];
+	for (size_t i = 0; i < sizeof(block); i++) {
+		p[i] = 0;
+	}
+}
+
+// An 8-lane batch costs about as much as two scalar chains, so below three output blocks
+// (60 bytes) the chains run one at a time even without SHA-NI
+static const size_t PBKDF2_MIN_LANES = 3;
+
+static void pbkdf2ChainsPortable(const uint32_t* inner, const uint32_t* outer, uint32_t u[5][SHA1Batch::LANES],
+	uint32_t t[5][SHA1Batch::LANES], uint32_t iterations) {
+	const size_t LANES = SHA1Batch::LANES;
+	uint32_t block[16][LANES] = { { 0 } };
+	uint32_t state[5][LANES];
+	uint32_t mask[LANES];
+	for (size_t l = 0; l < LANES; l++) {
+		block[5][l] = 0x80000000;
+		block[15][l] = 84 * 8;
+		mask[l] = 0xffffffff;
+	}
+
+	for (uint32_t n = 1; n < iterations; n++) {
+		for (uint8_t b = 0; b < 2; b++) {
+			const uint32_t* key = b == 0 ? inner : outer;
+			for (uint8_t i = 0; i < 5; i++) {
+				for (size_t l = 0; l < LANES; l++) {
+					block[i][l] = u[i][l];
+					state[i][l] = key[i];
+				}
+			}
+			SHA1Batch::compress(state, block, mask);
+			memcpy(u, state, sizeof(state));
+		}
+		for (uint8_t i = 0; i < 5; i++) {
+			for (size_t l = 0; l < LANES; l++) {
+				t[i][l] ^= u[i][l];
+			}
+		}
+	}
+
+	volatile uint32_t* p = &block[0][0];
+	for (size_t i = 0; i < 5 * LANES; i++) {
+		p[i] = 0;
+	}
+	p = &state[0][0];
+	for (size_t i = 0; i < 5 * LANES; i++) {
+		p[i] = 0;
+	}
+}
+
+template <>
+void BasicHMAC<SHA1>::pbkdf2(const uint8_t* password, size_t passwordLength, const uint8_t* salt, size_t saltLength,
+	uint32_t iterations, uint8_t* out, size_t length) {
+	const size_t LANES = SHA1Batch::LANES;
+	BasicHMAC prf(password, passwordLength);
+	uint32_t u[5][LANES], t[5][LANES];
+	size_t blocks = (length + SIZE - 1) / SIZE;
+
+	for (size_t first = 0; first < blocks; first += LANES) {
+		size_t lanes = blocks - first < LANES ? blocks - first : LANES;
+
+		// U1 = PRF(salt || INT(i)) goes through the regular path, the iterations do not
+		memset(u, 0, sizeof(u));
+		for (size_t l = 0; l < lanes; l++) {
+			uint32_t index = (uint32_t)(first + l + 1);
+			uint8_t c[4] = { (uint8_t)(index >> 24), (uint8_t)(index >> 16), (uint8_t)(index >> 8), (uint8_t)index };
+			uint8_t u1[SIZE];
+			prf.update(salt, saltLength);
+			prf.update(c, 4);
+			prf.digest(u1);
+			for (uint8_t i = 0; i < 5; i++) {
+				u[i][l] = ((uint32_t)u1[i * 4] << 24) | ((uint32_t)u1[i * 4 + 1] << 16) | ((uint32_t)u1[i * 4 + 2] << 8) | u1[i * 4 + 3];
+			}
+		}
+		memcpy(t, u, sizeof(t));
+
+		if (SHA1::accelerated() || lanes < PBKDF2_MIN_LANES) {
+			pbkdf2ChainsScalar(prf.m_innerKey.m_state, prf.m_outerKey.m_state, u, t, lanes, iterations);
+		}
+		else {
+			pbkdf2ChainsPortable(prf.m_innerKey.m_state, prf.m_outerKey.m_state, u, t, iterations);
+		}
+
+		for (size_t l = 0; l < lanes; l++) {
+			for (uint8_t i = 0; i < 5 && length > 0; i++) {
+				for (uint8_t j = 0; j < 4 && length > 0; j++, length--) {
+					*out++ = (uint8_t)(t[i][l] >> (24 - 8 * j));
+				}
+			}
+		}
+	}
+
+	volatile uint32_t* p = &u[0][0];
+	for (size_t i = 0; i < 5 * LANES; i++) {
+		p[i] = 0;
+	}
+	p = &t[0][0];
+	for (size_t i = 0; i < 5 * LANES; i++) {
+		p[i] = 0;
+	}
+}
+
+template class BasicHMAC<SHA1>;
+template class BasicHMAC<SHA256>;
+template class BasicHMAC<SHA512>;
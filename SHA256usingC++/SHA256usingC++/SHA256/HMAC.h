@@ -0,0 +1,50 @@
+#ifndef HMAC_H
+#define HMAC_H
+
+#include <cstddef>
+#include <cstdint>
+#include "SHA1.h"
+#include "SHA256.h"
+#include "SHA512.h"
+
+// HMAC (RFC 2104) over one of the hash classes. The keyed inner and outer states are
+// computed once, so each message costs only its own blocks plus two; digest() resets for
+// the next message.
+template <typename Hash>
+class BasicHMAC {
+
+public:
+	static constexpr size_t SIZE = Hash::SIZE;
+
+	BasicHMAC(const uint8_t* key, size_t length);
+
+	void update(const uint8_t* data, size_t length);
+	void digest(uint8_t* mac);
+
+	static void mac(const uint8_t* key, size_t keyLength, const uint8_t* data, size_t length, uint8_t* out);
+
+	// PBKDF2 (RFC 8018) with this HMAC as the PRF. Every iteration reuses the keyed states.
+	static void pbkdf2(const uint8_t* password, size_t passwordLength, const uint8_t* salt, size_t saltLength,
+		uint32_t iterations, uint8_t* out, size_t length);
+
+private:
+	Hash m_innerKey;
+	Hash m_outerKey;
+	Hash m_inner;
+};
+
+// PBKDF2WithHmacSHA1 runs tens of thousands of iterations on one-block messages, so it has
+// its own loop over precomputed blocks
+template <>
+void BasicHMAC<SHA1>::pbkdf2(const uint8_t* password, size_t passwordLength, const uint8_t* salt, size_t saltLength,
+	uint32_t iterations, uint8_t* out, size_t length);
+
+extern template class BasicHMAC<SHA1>;
+extern template class BasicHMAC<SHA256>;
+extern template class BasicHMAC<SHA512>;
+
+typedef BasicHMAC<SHA1> HMAC1;
+typedef BasicHMAC<SHA256> HMAC;
+typedef BasicHMAC<SHA512> HMAC512;
+
+#endif
@@ -0,0 +1,96 @@
+#include "HashPool.h"
+#include "SHA256Batch.h"
+#include <cstring>
+
+HashPool::HashPool(size_t workers, size_t capacity) : m_queue(capacity), m_stopping(false), m_sleeping(0) {
+	m_workers.resize(workers ? workers : 1);
+	for (auto& t : m_workers) {
+		t = std::thread(&HashPool::worker, this);
+	}
+}
+
+HashPool::~HashPool() {
+	{
+		std::lock_guard<std::mutex> lock(m_idleMutex);
+		m_stopping = true;
+	}
+	m_idle.notify_all();
+	for (auto& t : m_workers) {
+		t.join();
+	}
+}
+
+void HashPool::submit(const uint8_t* data, size_t length, Callback done, void* context) {
+	Job job = { data, length, done, context };
+
+	// A full queue pushes back on the producer instead of growing
+	while (!m_queue.push(job)) {
+		std::this_thread::yield();
+	}
+
+	// Both sides touch the sleeping count with read-modify-writes, which are totally ordered:
+	// either this one comes after a worker's increment and wakes it, or the worker's comes after
+	// this one and its recheck of the queue sees the job. Taking the mutex means a worker between
+	// its recheck and its wait cannot miss the notify.
+	if (m_sleeping.fetch_add(0, std::memory_order_seq_cst) > 0) {
+		{
+			std::lock_guard<std::mutex> lock(m_idleMutex);
+		}
+		m_idle.notify_one();
+	}
+}
+
+static void fulfil(void* context, const uint8_t* digest) {
+	std::promise<HashPool::Digest>* promise = static_cast<std::promise<HashPool::Digest>*>(context);
+	HashPool::Digest result;
+	memcpy(result.data(), digest, 32);
+	promise->set_value(result);
+	delete promise;
+}
+
+std::future<HashPool::Digest> HashPool::submit(const uint8_t* data, size_t length) {
+	std::promise<Digest>* promise = new std::promise<Digest>();
+	std::future<Digest> result = promise->get_future();
+	submit(data, length, fulfil, promise);
+	return result;
+}
+
+void HashPool::worker() {
+	Job jobs[BATCH];
+	const uint8_t* data[BATCH];
+	size_t lengths[BATCH];
+	uint8_t digests[BATCH * 32];
+	int spins = 0;
+
+	for (;;) {
+		size_t n = m_queue.popMany(jobs, BATCH);
+		if (n == 0) {
+			if (m_stopping) {
+				return;
+			}
+			if (++spins < 64) {
+				std::this_thread::yield();
+				continue;
+			}
+
+			// Announce the sleep before the last look at the queue, see submit()
+			std::unique_lock<std::mutex> lock(m_idleMutex);
+			m_sleeping.fetch_add(1, std::memory_order_seq_cst);
+			m_idle.wait(lock, [this]() { return m_stopping || !m_queue.empty(); });
+			m_sleeping.fetch_sub(1, std::memory_order_relaxed);
+			spins = 0;
+			continue;
+		}
+		spins = 0;
+
+		for (size_t i = 0; i < n; i++) {
+			data[i] = jobs[i].data;
+			lengths[i] = jobs[i].length;
+		}
+		SHA256Batch::hash(data, lengths, n, digests);
+
+		for (size_t i = 0; i < n; i++) {
+			jobs[i].done(jobs[i].context, digests + i * 32);
+		}
+	}
+}
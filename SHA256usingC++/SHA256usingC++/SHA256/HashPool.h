@@ -0,0 +1,56 @@
+#ifndef HASH_POOL_H
+#define HASH_POOL_H
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "SubmissionQueue.h"
+
+// In-process SHA-256 worker pool. Any thread submits (pointer, length, completion)
+// descriptors through a lock-free queue; workers drain them in batches and hash
+// each batch with SHA256Batch so small messages from different threads share lanes.
+// The caller keeps the data alive until its completion runs.
+class HashPool {
+
+public:
+	typedef std::array<uint8_t, 32> Digest;
+	// Runs on a worker thread once the digest is ready.
+	typedef void (*Callback)(void* context, const uint8_t* digest);
+
+	explicit HashPool(size_t workers, size_t capacity = 4096);
+	~HashPool();
+
+	HashPool(const HashPool&) = delete;
+	HashPool& operator=(const HashPool&) = delete;
+
+	void submit(const uint8_t* data, size_t length, Callback done, void* context);
+	std::future<Digest> submit(const uint8_t* data, size_t length);
+
+private:
+	struct Job {
+		const uint8_t* data;
+		size_t length;
+		Callback done;
+		void* context;
+	};
+
+	static constexpr size_t BATCH = 32;
+
+	SubmissionQueue<Job> m_queue;
+	std::vector<std::thread> m_workers;
+	std::atomic<bool> m_stopping;
+
+	// Parks idle workers; submit only takes the mutex when a worker is parked
+	std::mutex m_idleMutex;
+	std::condition_variable m_idle;
+	std::atomic<int> m_sleeping;
+
+	void worker();
+};
+
+#endif
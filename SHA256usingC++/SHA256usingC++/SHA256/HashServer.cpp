@@ -0,0 +1,418 @@
+#include "HashServer.h"
+#include "SHA256Batch.h"
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+
+#ifndef _WIN32
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+static const uint64_t LISTEN_ID = 0;
+static const uint64_t WAKE_ID = 1;
+static const size_t LATENCY_SAMPLES = 1 << 16;
+
+HashServer::HashServer(const std::string& path, size_t workers, size_t batchSize)
+	: m_path(path), m_batchSize(batchSize ? batchSize : 1), m_listenFd(-1), m_epollFd(-1), m_wakeFd(-1),
+	m_stopping(false), m_nextConn(WAKE_ID + 1), m_requests(0) {
+	m_workers.resize(workers ? workers : 1);
+	m_latencies.reserve(LATENCY_SAMPLES);
+}
+
+#ifndef _WIN32
+
+HashServer::~HashServer() {
+	for (auto& entry : m_connections) {
+		::close(entry.second.fd);
+	}
+	if (m_listenFd >= 0) {
+		::close(m_listenFd);
+		unlink(m_path.c_str());
+	}
+	if (m_wakeFd >= 0) {
+		::close(m_wakeFd);
+	}
+	if (m_epollFd >= 0) {
+		::close(m_epollFd);
+	}
+}
+
+bool HashServer::setup() {
+	sockaddr_un addr;
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	if (m_path.size() >= sizeof(addr.sun_path)) {
+		return false;
+	}
+	memcpy(addr.sun_path, m_path.c_str(), m_path.size());
+	unlink(m_path.c_str());
+
+	m_listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+	if (m_listenFd < 0 || bind(m_listenFd, (sockaddr*)&addr, sizeof(addr)) < 0 || listen(m_listenFd, SOMAXCONN) < 0) {
+		return false;
+	}
+
+	m_epollFd = epoll_create1(EPOLL_CLOEXEC);
+	m_wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if (m_epollFd < 0 || m_wakeFd < 0) {
+		return false;
+	}
+
+	epoll_event ev;
+	ev.events = EPOLLIN;
+	ev.data.u64 = LISTEN_ID;
+	epoll_ctl(m_epollFd, EPOLL_CTL_ADD, m_listenFd, &ev);
+	ev.data.u64 = WAKE_ID;
+	epoll_ctl(m_epollFd, EPOLL_CTL_ADD, m_wakeFd, &ev);
+	return true;
+}
+
+bool HashServer::run() {
+	if (!setup()) {
+		return false;
+	}
+
+	for (auto& t : m_workers) {
+		t = std::thread(&HashServer::worker, this);
+	}
+
+	epoll_event events[256];
+	while (!m_stopping) {
+		int n = epoll_wait(m_epollFd, events, 256, -1);
+		if (n < 0 && errno != EINTR) {
+			break;
+		}
+
+		for (int i = 0; i < n; i++) {
+			uint64_t id = events[i].data.u64;
+			if (id == LISTEN_ID) {
+				accept();
+				continue;
+			}
+			if (id == WAKE_ID) {
+				uint64_t count;
+				while (read(m_wakeFd, &count, sizeof(count)) > 0) {}
+				complete();
+				continue;
+			}
+
+			auto it = m_connections.find(id);
+			if (it == m_connections.end()) {
+				continue;
+			}
+			bool alive = !(events[i].events & (EPOLLERR | EPOLLHUP)) || (events[i].events & EPOLLIN);
+			if (alive && (events[i].events & EPOLLIN)) {
+				alive = readFrom(id, it->second);
+			}
+			if (alive && (events[i].events & EPOLLOUT)) {
+				alive = flush(id, it->second);
+			}
+			if (!alive || finished(it->second)) {
+				close(id);
+			}
+		}
+
+		// Everything read during this wakeup goes out as one set of batches
+		dispatch();
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_workMutex);
+		m_stopping = true;
+	}
+	m_workReady.notify_all();
+	for (auto& t : m_workers) {
+		t.join();
+	}
+	return true;
+}
+
+void HashServer::stop() {
+	uint64_t one = 1;
+	m_stopping = true;
+	if (m_wakeFd >= 0) {
+		ssize_t ignored = write(m_wakeFd, &one, sizeof(one));
+		(void)ignored;
+	}
+}
+
+void HashServer::accept() {
+	int fd;
+	while ((fd = accept4(m_listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC)) >= 0) {
+		uint64_t id = m_nextConn++;
+		Connection& conn = m_connections[id];
+		conn.fd = fd;
+		conn.outPos = 0;
+		conn.inFlight = 0;
+		conn.readClosed = false;
+
+		epoll_event ev;
+		ev.events = EPOLLIN;
+		ev.data.u64 = id;
+		epoll_ctl(m_epollFd, EPOLL_CTL_ADD, fd, &ev);
+	}
+}
+
+bool HashServer::readFrom(uint64_t id, Connection& conn) {
+	char buffer[65536];
+
+	// Stops at the high-water mark; the connection is read again once its responses drain
+	while (conn.inFlight + conn.out.size() - conn.outPos <= HIGH_WATER) {
+		ssize_t got = read(conn.fd, buffer, sizeof(buffer));
+		if (got == 0) {
+			conn.readClosed = true; // Half close: frames already received are still answered
+			break;
+		}
+		if (got < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			if (errno != EAGAIN && errno != EWOULDBLOCK) {
+				return false;
+			}
+			break;
+		}
+		conn.in.append(buffer, got);
+
+		// Split complete frames off the front of the input buffer
+		Clock::time_point now = Clock::now();
+		size_t pos = 0;
+		while (conn.in.size() - pos >= 8) {
+			uint32_t tag, length;
+			memcpy(&tag, conn.in.data() + pos, 4);
+			memcpy(&length, conn.in.data() + pos + 4, 4);
+			length = ntohl(length);
+			if (length > MAX_MESSAGE) {
+				return false;
+			}
+			if (conn.in.size() - pos - 8 < length) {
+				break;
+			}
+
+			Request request;
+			request.conn = id;
+			request.tag = ntohl(tag);
+			request.data.assign(conn.in, pos + 8, length);
+			request.arrived = now;
+			m_pending.push_back(std::move(request));
+			conn.inFlight += sizeof(Request) + length;
+			pos += 8 + length;
+		}
+		conn.in.erase(0, pos);
+	}
+
+	watch(id, conn);
+	return true;
+}
+
+bool HashServer::flush(uint64_t id, Connection& conn) {
+	while (conn.outPos < conn.out.size()) {
+		ssize_t sent = send(conn.fd, conn.out.data() + conn.outPos, conn.out.size() - conn.outPos, MSG_NOSIGNAL);
+		if (sent < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			if (errno != EAGAIN && errno != EWOULDBLOCK) {
+				return false;
+			}
+			break;
+		}
+		conn.outPos += sent;
+	}
+
+	if (conn.outPos == conn.out.size()) {
+		conn.out.clear();
+		conn.outPos = 0;
+	}
+
+	watch(id, conn);
+	return true;
+}
+
+void HashServer::watch(uint64_t id, Connection& conn) {
+	// Only wait for writability while something is queued, and stop reading past the high-water
+	// mark (or after the peer's EOF, which would otherwise be reported on every wakeup)
+	size_t queued = conn.inFlight + conn.out.size() - conn.outPos;
+	epoll_event ev;
+	ev.events = 0;
+	if (!conn.readClosed && queued <= HIGH_WATER) {
+		ev.events |= EPOLLIN;
+	}
+	if (conn.outPos < conn.out.size()) {
+		ev.events |= EPOLLOUT;
+	}
+	ev.data.u64 = id;
+	epoll_ctl(m_epollFd, EPOLL_CTL_MOD, conn.fd, &ev);
+}
+
+bool HashServer::finished(const Connection& conn) const {
+	return conn.readClosed && conn.inFlight == 0 && conn.out.empty();
+}
+
+void HashServer::close(uint64_t id) {
+	auto it = m_connections.find(id);
+	if (it == m_connections.end()) {
+		return;
+	}
+	epoll_ctl(m_epollFd, EPOLL_CTL_DEL, it->second.fd, nullptr);
+	::close(it->second.fd);
+	m_connections.erase(it);
+}
+
+void HashServer::dispatch() {
+	if (m_pending.empty()) {
+		return;
+	}
+
+	// Similar lengths share a batch so the lanes finish together
+	std::stable_sort(m_pending.begin(), m_pending.end(), [](const Request& a, const Request& b) {
+		return a.data.size() < b.data.size();
+	});
+
+	{
+		std::lock_guard<std::mutex> lock(m_workMutex);
+		for (size_t i = 0; i < m_pending.size(); i += m_batchSize) {
+			size_t end = std::min(i + m_batchSize, m_pending.size());
+			m_work.emplace_back(std::make_move_iterator(m_pending.begin() + i), std::make_move_iterator(m_pending.begin() + end));
+		}
+	}
+	m_pending.clear();
+	m_workReady.notify_all();
+}
+
+void HashServer::complete() {
+	std::vector<Response> done;
+	{
+		std::lock_guard<std::mutex> lock(m_doneMutex);
+		done.swap(m_done);
+	}
+
+	std::vector<uint64_t> touched;
+	Clock::time_point now = Clock::now();
+	{
+		std::lock_guard<std::mutex> lock(m_statsMutex);
+		for (const Response& response : done) {
+			uint32_t micros = (uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(now - response.arrived).count();
+			if (m_latencies.size() < LATENCY_SAMPLES) {
+				m_latencies.push_back(micros);
+			}
+			else {
+				m_latencies[m_requests % LATENCY_SAMPLES] = micros;
+			}
+			m_requests++;
+		}
+	}
+
+	for (const Response& response : done) {
+		auto it = m_connections.find(response.conn);
+		if (it == m_connections.end()) {
+			continue; // Client went away while its request was in flight
+		}
+
+		uint32_t tag = htonl(response.tag);
+		it->second.out.append((const char*)&tag, 4);
+		it->second.out.append((const char*)response.digest, 32);
+		it->second.inFlight -= sizeof(Request) + response.length;
+		touched.push_back(response.conn);
+	}
+
+	std::sort(touched.begin(), touched.end());
+	touched.erase(std::unique(touched.begin(), touched.end()), touched.end());
+	for (uint64_t id : touched) {
+		auto it = m_connections.find(id);
+		if (!flush(id, it->second) || finished(it->second)) {
+			close(id);
+		}
+	}
+}
+
+#else
+
+HashServer::~HashServer() {
+}
+
+bool HashServer::run() {
+	return false; // Needs Unix domain sockets and epoll
+}
+
+void HashServer::stop() {
+	m_stopping = true;
+}
+
+#endif
+
+void HashServer::worker() {
+	std::vector<const uint8_t*> data;
+	std::vector<size_t> lengths;
+	std::vector<uint8_t> digests;
+
+	for (;;) {
+		std::vector<Request> batch;
+		{
+			std::unique_lock<std::mutex> lock(m_workMutex);
+			m_workReady.wait(lock, [this] { return m_stopping || !m_work.empty(); });
+			if (m_work.empty()) {
+				return;
+			}
+			batch = std::move(m_work.front());
+			m_work.pop_front();
+		}
+
+		data.resize(batch.size());
+		lengths.resize(batch.size());
+		digests.resize(batch.size() * 32);
+		for (size_t i = 0; i < batch.size(); i++) {
+			data[i] = (const uint8_t*)batch[i].data.data();
+			lengths[i] = batch[i].data.size();
+		}
+		SHA256Batch::hash(data.data(), lengths.data(), batch.size(), digests.data());
+
+		{
+			std::lock_guard<std::mutex> lock(m_doneMutex);
+			for (size_t i = 0; i < batch.size(); i++) {
+				Response response;
+				response.conn = batch[i].conn;
+				response.tag = batch[i].tag;
+				response.length = (uint32_t)batch[i].data.size();
+				response.arrived = batch[i].arrived;
+				memcpy(response.digest, &digests[i * 32], 32);
+				m_done.push_back(response);
+			}
+		}
+
+#ifndef _WIN32
+		uint64_t one = 1;
+		ssize_t ignored = write(m_wakeFd, &one, sizeof(one));
+		(void)ignored;
+#endif
+	}
+}
+
+std::string HashServer::stats() {
+	std::vector<uint32_t> samples;
+	uint64_t requests;
+	{
+		std::lock_guard<std::mutex> lock(m_statsMutex);
+		samples = m_latencies;
+		requests = m_requests;
+	}
+
+	std::stringstream s;
+	s << "requests " << requests;
+	if (!samples.empty()) {
+		std::vector<uint32_t>::iterator p50 = samples.begin() + samples.size() / 2;
+		std::nth_element(samples.begin(), p50, samples.end());
+		s << " p50 " << *p50 << "us";
+		std::vector<uint32_t>::iterator p99 = samples.begin() + samples.size() * 99 / 100;
+		std::nth_element(samples.begin(), p99, samples.end());
+		s << " p99 " << *p99 << "us";
+	}
+	return s.str();
+}
@@ -0,0 +1,110 @@
+#ifndef HASH_SERVER_H
+#define HASH_SERVER_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Long-lived SHA-256 daemon on a Unix domain socket.
+//
+// Wire format (integers in network byte order):
+//   request:  uint32 tag, uint32 length, length bytes of data
+//   response: uint32 tag, 32 byte digest
+// Responses on one connection may come back out of order, the tag matches them up.
+//
+// Requests that arrive in the same event loop wakeup are coalesced into batches
+// of up to batchSize messages and hashed by the worker pool with SHA256Batch.
+//
+// A client may shut down its write side once it has sent its requests; the responses still
+// come back before the server closes. Reading from a connection pauses while more than
+// HIGH_WATER bytes of its requests and responses are queued, so a client that writes without
+// reading is held back by its own socket buffer instead of growing the daemon.
+class HashServer {
+
+public:
+	static constexpr uint32_t MAX_MESSAGE = 64 * 1024 * 1024;
+	static constexpr size_t HIGH_WATER = 4 * 1024 * 1024;
+
+	HashServer(const std::string& path, size_t workers, size_t batchSize);
+	~HashServer();
+
+	// Runs the event loop until stop() is called. Returns false if the socket could not be set up.
+	bool run();
+	// Safe to call from a signal handler.
+	void stop();
+
+	// Request count and p50/p99 latency (arrival to response queued), in microseconds.
+	std::string stats();
+
+private:
+	typedef std::chrono::steady_clock Clock;
+
+	struct Request {
+		uint64_t conn;
+		uint32_t tag;
+		std::string data;
+		Clock::time_point arrived;
+	};
+
+	struct Response {
+		uint64_t conn;
+		uint32_t tag;
+		uint32_t length;
+		uint8_t digest[32];
+		Clock::time_point arrived;
+	};
+
+	struct Connection {
+		int fd;
+		std::string in;
+		std::string out;
+		size_t outPos;
+		// Memory held by requests handed to the workers whose responses are not queued yet
+		size_t inFlight;
+		// The peer shut down its write side; the connection lives until its responses are sent
+		bool readClosed;
+	};
+
+	std::string m_path;
+	size_t m_batchSize;
+	int m_listenFd;
+	int m_epollFd;
+	int m_wakeFd;
+	std::atomic<bool> m_stopping;
+	uint64_t m_nextConn;
+
+	std::unordered_map<uint64_t, Connection> m_connections;
+	std::vector<Request> m_pending;
+
+	std::mutex m_workMutex;
+	std::condition_variable m_workReady;
+	std::deque<std::vector<Request>> m_work;
+	std::vector<std::thread> m_workers;
+
+	std::mutex m_doneMutex;
+	std::vector<Response> m_done;
+
+	std::mutex m_statsMutex;
+	std::vector<uint32_t> m_latencies; // Ring of the most recent samples
+	uint64_t m_requests;
+
+	bool setup();
+	void accept();
+	bool readFrom(uint64_t id, Connection& conn);
+	bool flush(uint64_t id, Connection& conn);
+	void watch(uint64_t id, Connection& conn);
+	bool finished(const Connection& conn) const;
+	void close(uint64_t id);
+	void dispatch();
+	void complete();
+	void worker();
+};
+
+#endif
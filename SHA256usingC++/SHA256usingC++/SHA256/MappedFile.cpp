@@ -0,0 +1,142 @@
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+MappedFile::MappedFile() : m_data(nullptr), m_size(0), m_file(INVALID_HANDLE_VALUE), m_mapping(nullptr) {
+}
+
+bool MappedFile::open(const std::string& path, bool writable) {
+	close();
+	m_file = CreateFileA(path.c_str(), GENERIC_READ | (writable ? GENERIC_WRITE : 0), FILE_SHARE_READ | FILE_SHARE_WRITE,
+		nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	return m_file != INVALID_HANDLE_VALUE && map(writable);
+}
+
+bool MappedFile::create(const std::string& path, uint64_t size) {
+	close();
+	m_file = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (m_file == INVALID_HANDLE_VALUE) {
+		return false;
+	}
+
+	LARGE_INTEGER end;
+	end.QuadPart = (LONGLONG)size;
+	return SetFilePointerEx(m_file, end, nullptr, FILE_BEGIN) && SetEndOfFile(m_file) && map(true);
+}
+
+bool MappedFile::map(bool writable) {
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(m_file, &size)) {
+		return false;
+	}
+	m_size = (uint64_t)size.QuadPart;
+	if (m_size == 0) {
+		return true;
+	}
+
+	m_mapping = CreateFileMappingA(m_file, nullptr, writable ? PAGE_READWRITE : PAGE_READONLY, 0, 0, nullptr);
+	if (!m_mapping) {
+		return false;
+	}
+	m_data = (uint8_t*)MapViewOfFile(m_mapping, writable ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, 0);
+	return m_data != nullptr;
+}
+
+void MappedFile::sync() {
+	if (m_data) {
+		FlushViewOfFile(m_data, 0);
+		FlushFileBuffers(m_file);
+	}
+}
+
+void MappedFile::close() {
+	if (m_data) {
+		UnmapViewOfFile(m_data);
+	}
+	if (m_mapping) {
+		CloseHandle(m_mapping);
+	}
+	if (m_file != INVALID_HANDLE_VALUE) {
+		CloseHandle(m_file);
+	}
+	m_data = nullptr;
+	m_mapping = nullptr;
+	m_file = INVALID_HANDLE_VALUE;
+	m_size = 0;
+}
+
+#else
+
+MappedFile::MappedFile() : m_data(nullptr), m_size(0), m_fd(-1) {
+}
+
+bool MappedFile::open(const std::string& path, bool writable) {
+	close();
+	m_fd = ::open(path.c_str(), (writable ? O_RDWR : O_RDONLY) | O_CLOEXEC);
+	return m_fd >= 0 && map(writable);
+}
+
+bool MappedFile::create(const std::string& path, uint64_t size) {
+	close();
+	m_fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+	return m_fd >= 0 && ftruncate(m_fd, (off_t)size) == 0 && map(true);
+}
+
+bool MappedFile::map(bool writable) {
+	struct stat st;
+	if (fstat(m_fd, &st) != 0) {
+		return false;
+	}
+	m_size = (uint64_t)st.st_size;
+	if (m_size == 0) {
+		return true;
+	}
+
+	void* data = mmap(nullptr, m_size, PROT_READ | (writable ? PROT_WRITE : 0), MAP_SHARED, m_fd, 0);
+	if (data == MAP_FAILED) {
+		return false;
+	}
+	m_data = (uint8_t*)data;
+	return true;
+}
+
+void MappedFile::sync() {
+	if (m_data) {
+		msync(m_data, m_size, MS_SYNC);
+	}
+}
+
+void MappedFile::close() {
+	if (m_data) {
+		munmap(m_data, m_size);
+	}
+	if (m_fd >= 0) {
+		::close(m_fd);
+	}
+	m_data = nullptr;
+	m_fd = -1;
+	m_size = 0;
+}
+
+#endif
+
+MappedFile::~MappedFile() {
+	close();
+}
+
+uint8_t* MappedFile::data() const {
+	return m_data;
+}
+
+uint64_t MappedFile::size() const {
+	return m_size;
+}
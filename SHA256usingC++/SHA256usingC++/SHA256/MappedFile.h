@@ -0,0 +1,41 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstdint>
+#include <string>
+
+// Whole-file memory mapping, read-only or shared read-write.
+class MappedFile {
+
+public:
+	MappedFile();
+	~MappedFile();
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	bool open(const std::string& path, bool writable);
+	// Creates the file (or truncates it) at the given size and maps it read-write.
+	bool create(const std::string& path, uint64_t size);
+	void close();
+
+	// Writes dirty pages back to the file.
+	void sync();
+
+	uint8_t* data() const;
+	uint64_t size() const;
+
+private:
+	uint8_t* m_data;
+	uint64_t m_size;
+#ifdef _WIN32
+	void* m_file;
+	void* m_mapping;
+#else
+	int m_fd;
+#endif
+
+	bool map(bool writable);
+};
+
+#endif
@@ -0,0 +1,215 @@
+#include "MerkleTree.h"
+#include "SHA256.h"
+#include "SHA256Batch.h"
+#include <algorithm>
+#include <cstring>
+#include <thread>
+
+static const char MAGIC[8] = { 'M', 'R', 'K', 'L', '0', '0', '0', '1' };
+// Work per thread below which splitting a level is not worth the thread start
+static const size_t MIN_SHARE = 256;
+static const size_t LEAF_BATCH = 64;
+static const size_t NODE_BATCH = 512;
+
+MerkleTree::MerkleTree(size_t threads) : m_threads(threads ? threads : 1), m_leafCount(0), m_capacity(1) {
+}
+
+uint8_t* MerkleTree::node(uint64_t i) const {
+	return m_index.data() + HEADER_SIZE + i * 32;
+}
+
+bool MerkleTree::build(const std::string& image, const std::string& index) {
+	if (!m_image.open(image, false)) {
+		return false;
+	}
+
+	m_leafCount = (m_image.size() + BLOCK - 1) / BLOCK;
+	m_capacity = 1;
+	while (m_capacity < m_leafCount) {
+		m_capacity <<= 1;
+	}
+
+	if (!m_index.create(index, HEADER_SIZE + 2 * m_capacity * 32)) {
+		return false;
+	}
+
+	Header header;
+	memcpy(header.magic, MAGIC, sizeof(MAGIC));
+	header.leafCount = m_leafCount;
+	header.capacity = m_capacity;
+	memcpy(m_index.data(), &header, sizeof(header));
+
+	// A build hashes whole levels, so nodes are given as a range rather than a list
+	parallel(nullptr, m_capacity, m_leafCount, &MerkleTree::hashLeaves);
+	memset(node(m_capacity + m_leafCount), 0, (m_capacity - m_leafCount) * 32);
+	for (uint64_t first = m_capacity / 2; first >= 1; first /= 2) {
+		parallel(nullptr, first, first, &MerkleTree::hashParents);
+	}
+
+	m_index.sync();
+	return true;
+}
+
+bool MerkleTree::open(const std::string& image, const std::string& index) {
+	if (!m_image.open(image, false) || !m_index.open(index, true) || m_index.size() < HEADER_SIZE) {
+		return false;
+	}
+
+	Header header;
+	memcpy(&header, m_index.data(), sizeof(header));
+	m_leafCount = header.leafCount;
+	m_capacity = header.capacity;
+
+	return memcmp(header.magic, MAGIC, sizeof(MAGIC)) == 0 &&
+		m_index.size() == HEADER_SIZE + 2 * m_capacity * 32 &&
+		m_leafCount == (m_image.size() + BLOCK - 1) / BLOCK;
+}
+
+bool MerkleTree::update(std::vector<uint64_t> blocks) {
+	std::sort(blocks.begin(), blocks.end());
+	blocks.erase(std::unique(blocks.begin(), blocks.end()), blocks.end());
+	if (blocks.empty()) {
+		return true;
+	}
+	if (blocks.back() >= m_leafCount) {
+		return false;
+	}
+
+	std::vector<uint64_t> level(blocks.size());
+	for (size_t i = 0; i < blocks.size(); i++) {
+		level[i] = m_capacity + blocks[i];
+	}
+	parallel(level.data(), 0, level.size(), &MerkleTree::hashLeaves);
+
+	// Sorted children give sorted parents, so duplicates are always adjacent
+	std::vector<uint64_t> parents;
+	while (level[0] > 1) {
+		parents.clear();
+		for (uint64_t i : level) {
+			if (parents.empty() || parents.back() != i / 2) {
+				parents.push_back(i / 2);
+			}
+		}
+
+		parallel(parents.data(), 0, parents.size(), &MerkleTree::hashParents);
+		level.swap(parents);
+	}
+
+	m_index.sync();
+	return true;
+}
+
+void MerkleTree::parallel(const uint64_t* nodes, uint64_t first, size_t count, Work work) {
+	size_t workers = std::min(m_threads, count / MIN_SHARE + 1);
+	if (workers <= 1) {
+		(this->*work)(nodes, first, count);
+		return;
+	}
+
+	std::vector<std::thread> threads;
+	size_t share = (count + workers - 1) / workers;
+	for (size_t begin = 0; begin < count; begin += share) {
+		threads.emplace_back(work, this, nodes ? nodes + begin : nullptr, first + begin, std::min(share, count - begin));
+	}
+	for (auto& t : threads) {
+		t.join();
+	}
+}
+
+void MerkleTree::hashLeaves(const uint64_t* nodes, uint64_t first, size_t count) {
+	std::vector<uint8_t> arena(LEAF_BATCH * (BLOCK + 1));
+	uint32_t offsets[LEAF_BATCH + 1];
+	uint8_t digests[LEAF_BATCH * 32];
+
+	for (size_t i = 0; i < count; i += LEAF_BATCH) {
+		size_t n = std::min(LEAF_BATCH, count - i);
+		offsets[0] = 0;
+		for (size_t j = 0; j < n; j++) {
+			uint64_t start = ((nodes ? nodes[i + j] : first + i + j) - m_capacity) * BLOCK;
+			size_t length = (size_t)std::min<uint64_t>(BLOCK, m_image.size() - start);
+
+			arena[offsets[j]] = 0x00;
+			memcpy(&arena[offsets[j] + 1], m_image.data() + start, length);
+			offsets[j + 1] = offsets[j] + 1 + (uint32_t)length;
+		}
+
+		SHA256Batch::hashArena(arena.data(), offsets, n, digests);
+		for (size_t j = 0; j < n; j++) {
+			memcpy(node(nodes ? nodes[i + j] : first + i + j), digests + j * 32, 32);
+		}
+	}
+}
+
+void MerkleTree::hashParents(const uint64_t* nodes, uint64_t first, size_t count) {
+	std::vector<uint8_t> arena(NODE_BATCH * 65);
+	uint32_t offsets[NODE_BATCH + 1];
+	uint8_t digests[NODE_BATCH * 32];
+
+	for (size_t i = 0; i < count; i += NODE_BATCH) {
+		size_t n = std::min(NODE_BATCH, count - i);
+		for (size_t j = 0; j < n; j++) {
+			// Both children are adjacent in the breadth first layout
+			arena[j * 65] = 0x01;
+			memcpy(&arena[j * 65 + 1], node((nodes ? nodes[i + j] : first + i + j) * 2), 64);
+			offsets[j] = (uint32_t)(j * 65);
+		}
+		offsets[n] = (uint32_t)(n * 65);
+
+		SHA256Batch::hashArena(arena.data(), offsets, n, digests);
+		for (size_t j = 0; j < n; j++) {
+			memcpy(node(nodes ? nodes[i + j] : first + i + j), digests + j * 32, 32);
+		}
+	}
+}
+
+MerkleTree::Hash MerkleTree::root() const {
+	Hash hash;
+	memcpy(hash.data(), node(1), 32);
+	return hash;
+}
+
+uint64_t MerkleTree::leafCount() const {
+	return m_leafCount;
+}
+
+std::vector<MerkleTree::Hash> MerkleTree::proof(uint64_t block) const {
+	std::vector<Hash> path;
+	for (uint64_t i = m_capacity + block; i > 1; i /= 2) {
+		Hash sibling;
+		memcpy(sibling.data(), node(i ^ 1), 32);
+		path.push_back(sibling);
+	}
+	return path;
+}
+
+MerkleTree::Hash MerkleTree::leafHash(const uint8_t* data, size_t length) {
+	const uint8_t prefix = 0x00;
+	Hash hash;
+	SHA256 sha;
+	sha.update(&prefix, 1);
+	sha.update(data, length);
+	sha.digest(hash.data());
+	return hash;
+}
+
+bool MerkleTree::verify(const Hash& leaf, uint64_t block, const std::vector<Hash>& proof, const Hash& root) {
+	const uint8_t prefix = 0x01;
+	Hash current = leaf;
+
+	for (const Hash& sibling : proof) {
+		SHA256 sha;
+		sha.update(&prefix, 1);
+		if (block & 1) {
+			sha.update(sibling.data(), 32);
+			sha.update(current.data(), 32);
+		}
+		else {
+			sha.update(current.data(), 32);
+			sha.update(sibling.data(), 32);
+		}
+		sha.digest(current.data());
+		block >>= 1;
+	}
+
+	return current == root;
+}
@@ -0,0 +1,69 @@
+#ifndef MERKLE_TREE_H
+#define MERKLE_TREE_H
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "MappedFile.h"
+
+// Persistent SHA-256 Merkle index over the 4 KiB blocks of a volume image.
+//
+// The tree is complete, padded with all-zero leaves up to a power of two, and stored
+// breadth first in a memory-mapped index file: node 1 is the root and node i has children
+// 2i and 2i + 1, so the leaves sit contiguously at [capacity, 2 * capacity). Leaves hash
+// 0x00 || block and inner nodes 0x01 || left || right, as in RFC 6962.
+//
+// Changing k blocks rehashes only the k leaves and the paths above them, one level at a
+// time, with every level split across the worker threads and hashed with SHA256Batch.
+class MerkleTree {
+
+public:
+	static constexpr size_t BLOCK = 4096;
+	typedef std::array<uint8_t, 32> Hash;
+
+	explicit MerkleTree(size_t threads);
+
+	// Hashes the whole image into a new index file.
+	bool build(const std::string& image, const std::string& index);
+	// Opens an existing index. The image must still have the same number of blocks.
+	bool open(const std::string& image, const std::string& index);
+
+	// Rehashes the given blocks, which have been rewritten in place, and their paths to the root.
+	// Returns false, leaving the tree untouched, if any block is past the end of the image.
+	bool update(std::vector<uint64_t> blocks);
+
+	Hash root() const;
+	uint64_t leafCount() const;
+
+	// Sibling hashes from the leaf up to just below the root.
+	std::vector<Hash> proof(uint64_t block) const;
+
+	static Hash leafHash(const uint8_t* data, size_t length);
+	static bool verify(const Hash& leaf, uint64_t block, const std::vector<Hash>& proof, const Hash& root);
+
+private:
+	struct Header {
+		char magic[8];
+		uint64_t leafCount;
+		uint64_t capacity;
+	};
+
+	static constexpr size_t HEADER_SIZE = 64;
+
+	size_t m_threads;
+	MappedFile m_image;
+	MappedFile m_index;
+	uint64_t m_leafCount;
+	uint64_t m_capacity;
+
+	// Hashes count nodes, listed in nodes or, when that is null, the range starting at first.
+	typedef void (MerkleTree::*Work)(const uint64_t* nodes, uint64_t first, size_t count);
+
+	uint8_t* node(uint64_t i) const;
+	void hashLeaves(const uint64_t* nodes, uint64_t first, size_t count);
+	void hashParents(const uint64_t* nodes, uint64_t first, size_t count);
+	void parallel(const uint64_t* nodes, uint64_t first, size_t count, Work work);
+};
+
+#endif
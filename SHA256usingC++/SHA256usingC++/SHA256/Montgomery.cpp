@@ -0,0 +1,151 @@
+#include "Montgomery.h"
+#include <algorithm>
+
+Montgomery::Montgomery(const BigInt& modulus) : m_modulus(modulus) {
+	m_size = (modulus.bits() + LIMB_BITS - 1) / LIMB_BITS;
+	m_n = toLimbs(modulus);
+
+	// n * n = 1 mod 8, and each Newton step doubles the correct low bits: 3, 6, 12, 24, 48, 96
+	Limb x = m_n[0];
+	for (int i = 0; i < 5; i++) {
+		x *= 2 - m_n[0] * x;
+	}
+	m_inverse = 0 - x;
+
+	m_one = toLimbs((BigInt(1) << (LIMB_BITS * m_size)) % modulus);
+	m_r2 = toLimbs((BigInt(1) << (2 * LIMB_BITS * m_size)) % modulus);
+}
+
+const BigInt& Montgomery::modulus() const {
+	return m_modulus;
+}
+
+std::vector<Montgomery::Limb> Montgomery::toLimbs(const BigInt& value) const {
+	const std::vector<uint32_t>& words = value.limbs();
+	std::vector<Limb> result(m_size, 0);
+	for (size_t i = 0; i < words.size() && i * 32 / LIMB_BITS < m_size; i++) {
+		result[i * 32 / LIMB_BITS] |= (Limb)words[i] << (i * 32 % LIMB_BITS);
+	}
+	return result;
+}
+
+BigInt Montgomery::fromLimbs(const std::vector<Limb>& limbs) {
+	std::vector<uint32_t> words;
+	for (Limb limb : limbs) {
+		for (size_t shift = 0; shift < LIMB_BITS; shift += 32) {
+			words.push_back((uint32_t)(limb >> shift));
+		}
+	}
+	return BigInt(words);
+}
+
+void Montgomery::multiply(const Limb* a, const Limb* b, Limb* out) const {
+	const size_t s = m_size;
+	Limb t[MAX_LIMBS + 2] = { 0 };
+
+	for (size_t i = 0; i < s; i++) {
+		Wide carry = 0;
+		for (size_t j = 0; j < s; j++) {
+			carry += (Wide)a[j] * b[i] + t[j];
+			t[j] = (Limb)carry;
+			carry >>= LIMB_BITS;
+		}
+		carry += t[s];
+		t[s] = (Limb)carry;
+		t[s + 1] = (Limb)(carry >> LIMB_BITS);
+
+		// Add m * n so the low limb cancels, then drop it
+		Limb m = t[0] * m_inverse;
+		carry = ((Wide)m * m_n[0] + t[0]) >> LIMB_BITS;
+		for (size_t j = 1; j < s; j++) {
+			carry += (Wide)m * m_n[j] + t[j];
+			t[j - 1] = (Limb)carry;
+			carry >>= LIMB_BITS;
+		}
+		carry += t[s];
+		t[s - 1] = (Limb)carry;
+		t[s] = t[s + 1] + (Limb)(carry >> LIMB_BITS);
+	}
+
+	// t < 2n; subtract n unless that borrows, choosing with a mask rather than a branch
+	Limb d[MAX_LIMBS];
+	Limb borrow = 0;
+	for (size_t j = 0; j < s; j++) {
+		Wide diff = (Wide)t[j] - m_n[j] - borrow;
+		d[j] = (Limb)diff;
+		borrow = (Limb)(diff >> (2 * LIMB_BITS - 1));
+	}
+	Limb keep = 0 - (Limb)(t[s] < borrow);
+	for (size_t j = 0; j < s; j++) {
+		out[j] = (t[j] & keep) | (d[j] & ~keep);
+	}
+}
+
+BigInt Montgomery::multiply(const BigInt& a, const BigInt& b) const {
+	std::vector<Limb> x = toLimbs(a % m_modulus), y = toLimbs(b % m_modulus);
+	multiply(x.data(), y.data(), x.data());
+	multiply(x.data(), m_r2.data(), x.data());
+	return fromLimbs(x);
+}
+
+BigInt Montgomery::pow(const BigInt& base, const BigInt& exponent) const {
+	const size_t s = m_size;
+	const size_t entries = (size_t)1 << WINDOW;
+
+	// table[i] = base^i in Montgomery form
+	std::vector<Limb> table(entries * s);
+	std::copy(m_one.begin(), m_one.end(), table.begin());
+	std::vector<Limb> b = toLimbs(base % m_modulus);
+	multiply(b.data(), m_r2.data(), &table[s]);
+	for (size_t i = 2; i < entries; i++) {
+		multiply(&table[(i - 1) * s], &table[s], &table[i * s]);
+	}
+
+	// Digits come from a zero padded copy so reading them does not depend on the exponent's length
+	size_t bits = std::max(exponent.limbs().size() * 32, s * LIMB_BITS);
+	bits = (bits + WINDOW - 1) / WINDOW * WINDOW;
+	std::vector<uint32_t> e(exponent.limbs());
+	e.resize(bits / 32, 0);
+
+	std::vector<Limb> result(m_one), selected(s);
+	for (size_t w = bits; w > 0; w -= WINDOW) {
+		for (size_t i = 0; i < WINDOW; i++) {
+			multiply(result.data(), result.data(), result.data());
+		}
+
+		// WINDOW divides 32, so a window never straddles two words
+		size_t low = w - WINDOW;
+		Limb digit = (e[low / 32] >> (low % 32)) & (entries - 1);
+		for (size_t i = 0; i < entries; i++) {
+			Limb mask = 0 - (Limb)(i == digit);
+			for (size_t j = 0; j < s; j++) {
+				selected[j] = (selected[j] & ~mask) | (table[i * s + j] & mask);
+			}
+		}
+		multiply(result.data(), selected.data(), result.data());
+	}
+
+	// Out of Montgomery form
+	std::vector<Limb> one(s, 0);
+	one[0] = 1;
+	multiply(result.data(), one.data(), result.data());
+	return fromLimbs(result);
+}
+
+BigInt Montgomery::powPublic(const BigInt& base, const BigInt& exponent) const {
+	std::vector<Limb> b = toLimbs(base % m_modulus);
+	multiply(b.data(), m_r2.data(), b.data());
+
+	std::vector<Limb> result(m_one);
+	for (size_t i = exponent.bits(); i-- > 0;) {
+		multiply(result.data(), result.data(), result.data());
+		if (exponent.bit(i)) {
+			multiply(result.data(), b.data(), result.data());
+		}
+	}
+
+	std::vector<Limb> one(m_size, 0);
+	one[0] = 1;
+	multiply(result.data(), one.data(), result.data());
+	return fromLimbs(result);
+}
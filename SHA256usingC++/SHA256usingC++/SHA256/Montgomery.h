@@ -0,0 +1,61 @@
+#ifndef MONTGOMERY_H
+#define MONTGOMERY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "BigInt.h"
+
+// Arithmetic modulo a fixed odd modulus in Montgomery form (CIOS multiplication). Works on
+// 64-bit limbs where the compiler has a 128-bit product, otherwise on BigInt's 32-bit ones.
+//
+// pow() runs through every exponent window of the modulus width, reads the whole window
+// table for each lookup and subtracts with masks, so its timing depends on the operand sizes
+// only and not on the exponent or base.
+class Montgomery {
+
+public:
+	static constexpr size_t WINDOW = 4;
+	static_assert(32 % WINDOW == 0, "exponent windows must not straddle 32-bit words");
+	static constexpr size_t MAX_BITS = 8192;
+
+	// The modulus must be odd and at most MAX_BITS.
+	explicit Montgomery(const BigInt& modulus);
+
+	const BigInt& modulus() const;
+
+	// base^exponent mod modulus
+	BigInt pow(const BigInt& base, const BigInt& exponent) const;
+	// Square and multiply over the exponent's own bits: variable time, so only for public
+	// exponents such as e, where it costs 17 multiplications instead of a full window pass.
+	BigInt powPublic(const BigInt& base, const BigInt& exponent) const;
+	// a * b mod modulus
+	BigInt multiply(const BigInt& a, const BigInt& b) const;
+
+private:
+#ifdef __SIZEOF_INT128__
+	typedef uint64_t Limb;
+	typedef unsigned __int128 Wide;
+#else
+	typedef uint32_t Limb;
+	typedef uint64_t Wide;
+#endif
+	static constexpr size_t LIMB_BITS = sizeof(Limb) * 8;
+	static constexpr size_t MAX_LIMBS = MAX_BITS / LIMB_BITS;
+
+	BigInt m_modulus;
+	size_t m_size;
+	// -modulus^-1 mod 2^LIMB_BITS
+	Limb m_inverse;
+	std::vector<Limb> m_n;
+	// R mod n and R^2 mod n for R = 2^(LIMB_BITS * size)
+	std::vector<Limb> m_one;
+	std::vector<Limb> m_r2;
+
+	std::vector<Limb> toLimbs(const BigInt& value) const;
+	static BigInt fromLimbs(const std::vector<Limb>& limbs);
+	// out = a * b / R mod n; out may alias a or b
+	void multiply(const Limb* a, const Limb* b, Limb* out) const;
+};
+
+#endif
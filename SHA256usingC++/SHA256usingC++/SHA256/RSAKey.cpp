@@ -0,0 +1,263 @@
+#include "RSAKey.h"
+#include "Montgomery.h"
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <thread>
+
+// Offsets (candidates start + 2k) sieved per window, and windows tried before a fresh start
+static const size_t SIEVE = 4096;
+static const size_t WINDOWS = 8;
+
+static const uint8_t RSA_ENCRYPTION[] = { 0x06, 0x09, 0x2a, 0x86, 0x48, 0x86, 0xf7, 0x0d, 0x01, 0x01, 0x01, 0x05, 0x00 };
+
+// Odd primes below 2^16
+static const std::vector<uint32_t>& smallPrimes() {
+	static const std::vector<uint32_t> primes = [] {
+		std::vector<uint32_t> result;
+		std::vector<bool> composite(65536, false);
+		for (uint32_t i = 3; i < 65536; i += 2) {
+			if (!composite[i]) {
+				result.push_back(i);
+				for (uint32_t j = i * i; j < 65536; j += 2 * i) {
+					composite[j] = true;
+				}
+			}
+		}
+		return result;
+	}();
+	return primes;
+}
+
+// Miller-Rabin rounds for a 2^-100 error bound, FIPS 186-4 table C.3
+static size_t roundsFor(size_t bits) {
+	return bits >= 1536 ? 4 : bits >= 1024 ? 5 : 7;
+}
+
+bool RSAKey::isProbablePrime(const BigInt& candidate, size_t rounds) {
+	if (candidate.compare(BigInt(4)) < 0) {
+		return candidate == BigInt(2) || candidate == BigInt(3);
+	}
+	if (!candidate.isOdd()) {
+		return false;
+	}
+
+	BigInt minusOne = candidate - BigInt(1);
+	size_t s = 0;
+	while (!minusOne.bit(s)) {
+		s++;
+	}
+	BigInt d = minusOne >> s;
+	Montgomery mont(candidate);
+
+	for (size_t round = 0; round < rounds; round++) {
+		// Base 2 first: it rejects almost every composite and costs no random draw
+		BigInt base = round == 0 ? BigInt(2) : BigInt::random(candidate.bits()) % (candidate - BigInt(3)) + BigInt(2);
+		BigInt x = mont.pow(base, d);
+		if (x == BigInt(1) || x == minusOne) {
+			continue;
+		}
+
+		bool witness = true;
+		for (size_t i = 1; i < s && witness; i++) {
+			x = mont.multiply(x, x);
+			witness = x != minusOne;
+		}
+		if (witness) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void RSAKey::findPrimes(size_t bits, size_t threads, BigInt& p, BigInt& q) {
+	std::mutex mutex;
+	std::vector<BigInt> found;
+	std::atomic<bool> done(false);
+
+	auto worker = [&]() {
+		const std::vector<uint32_t>& primes = smallPrimes();
+		std::vector<uint32_t> residues(primes.size());
+		std::vector<uint8_t> composite(SIEVE);
+
+		while (!done) {
+			// Top two bits set so that p * q has exactly twice the bits
+			BigInt start = BigInt::random(bits);
+			start.setBit(bits - 1);
+			start.setBit(bits - 2);
+			start.setBit(0);
+			for (size_t i = 0; i < primes.size(); i++) {
+				residues[i] = start.mod(primes[i]);
+			}
+
+			bool restart = false;
+			for (size_t window = 0; window < WINDOWS && !restart && !done; window++) {
+				// start + 2k is divisible by prime exactly when k = -residue / 2 mod prime
+				std::fill(composite.begin(), composite.end(), 0);
+				for (size_t i = 0; i < primes.size(); i++) {
+					uint32_t prime = primes[i];
+					uint32_t r = residues[i];
+					for (size_t k = (size_t)((uint64_t)(r ? prime - r : 0) * ((prime + 1) / 2) % prime); k < SIEVE; k += prime) {
+						composite[k] = 1;
+					}
+					// Move on to the next window incrementally instead of dividing again
+					residues[i] = (uint32_t)((r + 2 * (uint64_t)SIEVE) % prime);
+				}
+
+				BigInt base = start + BigInt((uint32_t)(2 * SIEVE * window));
+				for (size_t k = 0; k < SIEVE && !done; k++) {
+					if (composite[k]) {
+						continue;
+					}
+					BigInt candidate = base + BigInt((uint32_t)(2 * k));
+					if (candidate.bits() != bits) {
+						restart = true;
+						break;
+					}
+					// gcd(e, p - 1) must be 1, and e is prime
+					if (candidate.mod(EXPONENT) == 1 || !isProbablePrime(candidate, roundsFor(bits))) {
+						continue;
+					}
+
+					std::lock_guard<std::mutex> lock(mutex);
+					if (found.size() < 2 && (found.empty() || found[0] != candidate)) {
+						found.push_back(candidate);
+						done = found.size() == 2;
+					}
+					// Each prime comes from its own random start
+					restart = true;
+					break;
+				}
+			}
+		}
+	};
+
+	std::vector<std::thread> pool;
+	for (size_t t = 1; t < threads; t++) {
+		pool.emplace_back(worker);
+	}
+	worker();
+	for (auto& t : pool) {
+		t.join();
+	}
+
+	p = found[0];
+	q = found[1];
+}
+
+RSAKey RSAKey::generate(size_t bits, size_t threads) {
+	RSAKey key;
+	key.e = BigInt(EXPONENT);
+
+	for (;;) {
+		findPrimes(bits / 2, threads ? threads : 1, key.p, key.q);
+		if (key.p < key.q) {
+			std::swap(key.p, key.q);
+		}
+		// FIPS 186-4 B.3.3: p and q must not be too close
+		if ((key.p - key.q).bits() <= bits / 2 - 100) {
+			continue;
+		}
+
+		BigInt p1 = key.p - BigInt(1), q1 = key.q - BigInt(1);
+		BigInt lambda = p1 * q1 / BigInt::gcd(p1, q1);
+		key.d = BigInt::inverse(key.e, lambda);
+		if (key.d.bits() <= bits / 2) {
+			continue;
+		}
+
+		key.n = key.p * key.q;
+		key.dp = key.d % p1;
+		key.dq = key.d % q1;
+		key.qinv = BigInt::inverse(key.q, key.p);
+		return key;
+	}
+}
+
+static void derLength(std::vector<uint8_t>& out, size_t length) {
+	if (length < 0x80) {
+		out.push_back((uint8_t)length);
+		return;
+	}
+	uint8_t bytes = 0;
+	for (size_t l = length; l; l >>= 8) {
+		bytes++;
+	}
+	out.push_back(0x80 | bytes);
+	for (uint8_t i = bytes; i-- > 0;) {
+		out.push_back((uint8_t)(length >> (8 * i)));
+	}
+}
+
+static std::vector<uint8_t> derWrap(uint8_t tag, const std::vector<uint8_t>& content) {
+	std::vector<uint8_t> out;
+	out.push_back(tag);
+	derLength(out, content.size());
+	out.insert(out.end(), content.begin(), content.end());
+	return out;
+}
+
+static void derInteger(std::vector<uint8_t>& out, const BigInt& value) {
+	std::vector<uint8_t> bytes = value.toBytes();
+	// DER integers are signed
+	if (bytes[0] & 0x80) {
+		bytes.insert(bytes.begin(), 0x00);
+	}
+	std::vector<uint8_t> integer = derWrap(0x02, bytes);
+	out.insert(out.end(), integer.begin(), integer.end());
+}
+
+std::vector<uint8_t> RSAKey::privateDER() const {
+	std::vector<uint8_t> content;
+	derInteger(content, BigInt());
+	for (const BigInt* value : { &n, &e, &d, &p, &q, &dp, &dq, &qinv }) {
+		derInteger(content, *value);
+	}
+	return derWrap(0x30, content);
+}
+
+std::vector<uint8_t> RSAKey::publicDER() const {
+	std::vector<uint8_t> key;
+	derInteger(key, n);
+	derInteger(key, e);
+
+	std::vector<uint8_t> bits(1, 0x00);
+	std::vector<uint8_t> sequence = derWrap(0x30, key);
+	bits.insert(bits.end(), sequence.begin(), sequence.end());
+
+	std::vector<uint8_t> content = derWrap(0x30, std::vector<uint8_t>(RSA_ENCRYPTION, RSA_ENCRYPTION + sizeof(RSA_ENCRYPTION)));
+	std::vector<uint8_t> bitString = derWrap(0x03, bits);
+	content.insert(content.end(), bitString.begin(), bitString.end());
+	return derWrap(0x30, content);
+}
+
+std::string RSAKey::privateText() const {
+	return base64(privateDER());
+}
+
+std::string RSAKey::publicText() const {
+	return base64(publicDER());
+}
+
+std::string RSAKey::base64(const std::vector<uint8_t>& data) {
+	static const char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+	std::string out;
+	out.reserve((data.size() + 2) / 3 * 4);
+
+	for (size_t i = 0; i < data.size(); i += 3) {
+		uint32_t group = (uint32_t)data[i] << 16;
+		if (i + 1 < data.size()) {
+			group |= (uint32_t)data[i + 1] << 8;
+		}
+		if (i + 2 < data.size()) {
+			group |= data[i + 2];
+		}
+		out.push_back(alphabet[(group >> 18) & 63]);
+		out.push_back(alphabet[(group >> 12) & 63]);
+		out.push_back(i + 1 < data.size() ? alphabet[(group >> 6) & 63] : '=');
+		out.push_back(i + 2 < data.size() ? alphabet[group & 63] : '=');
+	}
+
+	return out;
+}
@@ -0,0 +1,40 @@
+#ifndef RSA_KEY_H
+#define RSA_KEY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "BigInt.h"
+
+// RSA private key with its CRT parameters, generated natively.
+//
+// Prime search runs on a pool of threads that each sieve their own random interval against
+// the odd primes below 2^16 and run Miller-Rabin on the survivors; p and q are simply the
+// first two primes found, so many candidates are in flight at once and a slow candidate
+// does not hold up the key. Exports match RSA/rsa_kyx.py key_export_to_text: base64 of a
+// PKCS#1 RSAPrivateKey, or of a SubjectPublicKeyInfo for the public key.
+class RSAKey {
+
+public:
+	static constexpr uint32_t EXPONENT = 65537;
+
+	BigInt n, e, d, p, q, dp, dq, qinv;
+
+	// bits must be even and at least 1024.
+	static RSAKey generate(size_t bits, size_t threads);
+
+	static bool isProbablePrime(const BigInt& candidate, size_t rounds);
+
+	std::vector<uint8_t> privateDER() const;
+	std::vector<uint8_t> publicDER() const;
+	std::string privateText() const;
+	std::string publicText() const;
+
+	static std::string base64(const std::vector<uint8_t>& data);
+
+private:
+	static void findPrimes(size_t bits, size_t threads, BigInt& p, BigInt& q);
+};
+
+#endif
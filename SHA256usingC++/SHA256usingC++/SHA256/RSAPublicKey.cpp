@@ -0,0 +1,154 @@
+#include "RSAPublicKey.h"
+#include "Random.h"
+#include <cstring>
+#include <vector>
+
+static const uint8_t RSA_ENCRYPTION[] = { 0x2a, 0x86, 0x48, 0x86, 0xf7, 0x0d, 0x01, 0x01, 0x01 };
+
+// Reads one DER element with the given tag and moves p past it.
+static bool derRead(const uint8_t*& p, const uint8_t* end, uint8_t tag, const uint8_t*& content, size_t& length) {
+	if (end - p < 2 || *p != tag) {
+		return false;
+	}
+	p++;
+
+	length = *p++;
+	if (length & 0x80) {
+		size_t bytes = length & 0x7f;
+		if (bytes == 0 || bytes > 4 || (size_t)(end - p) < bytes) {
+			return false;
+		}
+		length = 0;
+		for (size_t i = 0; i < bytes; i++) {
+			length = (length << 8) | *p++;
+		}
+	}
+	if ((size_t)(end - p) < length) {
+		return false;
+	}
+
+	content = p;
+	p += length;
+	return true;
+}
+
+static bool derInteger(const uint8_t*& p, const uint8_t* end, BigInt& value) {
+	const uint8_t* content;
+	size_t length;
+	// Negative integers are not valid key parameters
+	if (!derRead(p, end, 0x02, content, length) || length == 0 || (content[0] & 0x80)) {
+		return false;
+	}
+	value = BigInt::fromBytes(content, length);
+	return true;
+}
+
+RSAPublicKey::RSAPublicKey() : m_size(0) {
+}
+
+bool RSAPublicKey::parse(const uint8_t* der, size_t length) {
+	const uint8_t* p = der;
+	const uint8_t* end = der + length;
+	const uint8_t* content;
+	size_t size;
+	if (!derRead(p, end, 0x30, content, size) || p != end) {
+		return false;
+	}
+
+	p = content;
+	end = content + size;
+	if (p < end && *p == 0x30) {
+		// SubjectPublicKeyInfo: the algorithm must be rsaEncryption, the key sits in a bit string
+		const uint8_t* algorithm;
+		const uint8_t* oid;
+		const uint8_t* bits;
+		size_t algorithmSize, oidSize, bitsSize;
+		if (!derRead(p, end, 0x30, algorithm, algorithmSize) ||
+			!derRead(algorithm, algorithm + algorithmSize, 0x06, oid, oidSize) ||
+			oidSize != sizeof(RSA_ENCRYPTION) || memcmp(oid, RSA_ENCRYPTION, oidSize) != 0 ||
+			!derRead(p, end, 0x03, bits, bitsSize) || bitsSize < 1 || bits[0] != 0) {
+			return false;
+		}
+
+		p = bits + 1;
+		end = bits + bitsSize;
+		if (!derRead(p, end, 0x30, content, size) || p != end) {
+			return false;
+		}
+		p = content;
+		end = content + size;
+	}
+
+	BigInt n, e;
+	if (!derInteger(p, end, n) || !derInteger(p, end, e) || p != end) {
+		return false;
+	}
+	if (!n.isOdd() || n.bits() < 512 || n.bits() > Montgomery::MAX_BITS || !e.isOdd() || e.compare(BigInt(3)) < 0) {
+		return false;
+	}
+
+	m_n = n;
+	m_e = e;
+	m_mont.reset(new Montgomery(n));
+	m_size = (n.bits() + 7) / 8;
+	return true;
+}
+
+size_t RSAPublicKey::size() const {
+	return m_size;
+}
+
+// XORs MGF1(seed) into out. The seed is absorbed once; every counter then starts from a copy
+// of that state, so a seed spanning several blocks is not recompressed per output block.
+template <typename Hash>
+static void mgf1(const uint8_t* seed, size_t seedLength, uint8_t* out, size_t length) {
+	uint8_t mask[Hash::SIZE];
+	Hash prefix;
+	prefix.update(seed, seedLength);
+	for (uint32_t counter = 0; length > 0; counter++) {
+		uint8_t c[4] = { (uint8_t)(counter >> 24), (uint8_t)(counter >> 16), (uint8_t)(counter >> 8), (uint8_t)counter };
+		Hash hash = prefix;
+		hash.update(c, 4);
+		hash.digest(mask);
+
+		size_t take = length < Hash::SIZE ? length : Hash::SIZE;
+		for (size_t i = 0; i < take; i++) {
+			out[i] ^= mask[i];
+		}
+		out += take;
+		length -= take;
+	}
+}
+
+template <typename Hash>
+bool RSAPublicKey::encryptOAEP(const uint8_t* message, size_t length, uint8_t* out) const {
+	const size_t h = Hash::SIZE;
+	if (!m_mont || m_size < 2 * h + 2 || length > m_size - 2 * h - 2) {
+		return false;
+	}
+
+	// EM = 0x00 || maskedSeed || maskedDB, DB = lHash || PS || 0x01 || M
+	std::vector<uint8_t> em(m_size, 0);
+	uint8_t* seed = &em[1];
+	uint8_t* db = &em[1 + h];
+	size_t dbLength = m_size - h - 1;
+
+	Hash label;
+	label.digest(db);
+	db[dbLength - length - 1] = 0x01;
+	memcpy(db + dbLength - length, message, length);
+
+	Random::fill(seed, h);
+	mgf1<Hash>(seed, h, db, dbLength);
+	mgf1<Hash>(db, dbLength, seed, h);
+
+	BigInt c = m_mont->powPublic(BigInt::fromBytes(em.data(), em.size()), m_e);
+	std::vector<uint8_t> bytes = c.toBytes();
+	memset(out, 0, m_size - bytes.size());
+	memcpy(out + m_size - bytes.size(), bytes.data(), bytes.size());
+	return true;
+}
+
+template bool RSAPublicKey::encryptOAEP<SHA1>(const uint8_t*, size_t, uint8_t*) const;
+template bool RSAPublicKey::encryptOAEP<SHA256>(const uint8_t*, size_t, uint8_t*) const;
+template bool RSAPublicKey::encryptOAEP<SHA512>(const uint8_t*, size_t, uint8_t*) const;
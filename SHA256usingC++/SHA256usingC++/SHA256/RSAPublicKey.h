@@ -0,0 +1,43 @@
+#ifndef RSA_PUBLIC_KEY_H
+#define RSA_PUBLIC_KEY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include "BigInt.h"
+#include "Montgomery.h"
+#include "SHA1.h"
+#include "SHA256.h"
+#include "SHA512.h"
+
+// RSA public key for encryption. Parsing the DER and setting up the Montgomery context is
+// the expensive part, so a key is parsed once and then reused for every message.
+class RSAPublicKey {
+
+public:
+	RSAPublicKey();
+
+	// A SubjectPublicKeyInfo (RSAKey::publicDER, Java's X509EncodedKeySpec) or a bare PKCS#1
+	// RSAPublicKey. Returns false for anything else.
+	bool parse(const uint8_t* der, size_t length);
+
+	// Modulus size in bytes, which is also the ciphertext size.
+	size_t size() const;
+
+	// RSAES-OAEP (RFC 8017) with MGF1 over Hash and an empty label, writing size() bytes.
+	// Returns false if the message is longer than size() - 2 * Hash::SIZE - 2.
+	template <typename Hash>
+	bool encryptOAEP(const uint8_t* message, size_t length, uint8_t* out) const;
+
+private:
+	BigInt m_n;
+	BigInt m_e;
+	std::unique_ptr<Montgomery> m_mont;
+	size_t m_size;
+};
+
+extern template bool RSAPublicKey::encryptOAEP<SHA1>(const uint8_t*, size_t, uint8_t*) const;
+extern template bool RSAPublicKey::encryptOAEP<SHA256>(const uint8_t*, size_t, uint8_t*) const;
+extern template bool RSAPublicKey::encryptOAEP<SHA512>(const uint8_t*, size_t, uint8_t*) const;
+
+#endif
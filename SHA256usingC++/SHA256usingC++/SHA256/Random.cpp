@@ -0,0 +1,196 @@
+#include "Random.h"
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <bcrypt.h>
+#pragma comment(lib, "bcrypt.lib")
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <pthread.h>
+#include <unistd.h>
+#if defined(__linux__)
+#include <sys/random.h>
+#endif
+#endif
+
+// Bumped in the child after fork(), so generators copied from the parent reseed
+static std::atomic<uint32_t> g_forks(0);
+
+#ifndef _WIN32
+static void onFork() {
+	g_forks++;
+}
+#endif
+
+struct Generator {
+	uint8_t key[32];
+	uint8_t buffer[Random::BUFFER];
+	size_t used;
+	uint64_t generated;
+	uint32_t forks;
+	bool seeded;
+
+	Generator() : used(Random::BUFFER), generated(0), forks(0), seeded(false) {
+	}
+
+	~Generator() {
+		volatile uint8_t* p = key;
+		for (size_t i = 0; i < sizeof(key); i++) {
+			p[i] = 0;
+		}
+		p = buffer;
+		for (size_t i = 0; i < sizeof(buffer); i++) {
+			p[i] = 0;
+		}
+	}
+};
+
+static inline uint32_t rotl(uint32_t x, uint32_t n) {
+	return (x << n) | (x >> (32 - n));
+}
+
+void Random::chacha20(const uint8_t* key, uint64_t counter, uint8_t* out) {
+	// Word i of every block sits in x[i][lane], so the quarter rounds are lane loops
+	uint32_t input[16][LANES];
+	uint32_t x[16][LANES];
+
+	static const uint32_t sigma[4] = { 0x61707865, 0x3320646e, 0x79622d32, 0x6b206574 };
+	for (size_t lane = 0; lane < LANES; lane++) {
+		for (size_t i = 0; i < 4; i++) {
+			input[i][lane] = sigma[i];
+		}
+		for (size_t i = 0; i < 8; i++) {
+			input[4 + i][lane] = (uint32_t)key[i * 4] | ((uint32_t)key[i * 4 + 1] << 8) |
+				((uint32_t)key[i * 4 + 2] << 16) | ((uint32_t)key[i * 4 + 3] << 24);
+		}
+		input[12][lane] = (uint32_t)(counter + lane);
+		input[13][lane] = (uint32_t)((counter + lane) >> 32);
+		input[14][lane] = 0;
+		input[15][lane] = 0;
+	}
+	memcpy(x, input, sizeof(x));
+
+#define QUARTER(a, b, c, d) \
+	for (size_t l = 0; l < LANES; l++) { \
+		x[a][l] += x[b][l]; x[d][l] = rotl(x[d][l] ^ x[a][l], 16); \
+		x[c][l] += x[d][l]; x[b][l] = rotl(x[b][l] ^ x[c][l], 12); \
+		x[a][l] += x[b][l]; x[d][l] = rotl(x[d][l] ^ x[a][l], 8); \
+		x[c][l] += x[d][l]; x[b][l] = rotl(x[b][l] ^ x[c][l], 7); \
+	}
+
+	for (size_t round = 0; round < 10; round++) {
+		QUARTER(0, 4, 8, 12)
+		QUARTER(1, 5, 9, 13)
+		QUARTER(2, 6, 10, 14)
+		QUARTER(3, 7, 11, 15)
+		QUARTER(0, 5, 10, 15)
+		QUARTER(1, 6, 11, 12)
+		QUARTER(2, 7, 8, 13)
+		QUARTER(3, 4, 9, 14)
+	}
+
+#undef QUARTER
+
+	for (size_t lane = 0; lane < LANES; lane++) {
+		for (size_t i = 0; i < 16; i++) {
+			uint32_t v = x[i][lane] + input[i][lane];
+			uint8_t* p = out + lane * 64 + i * 4;
+			p[0] = (uint8_t)v;
+			p[1] = (uint8_t)(v >> 8);
+			p[2] = (uint8_t)(v >> 16);
+			p[3] = (uint8_t)(v >> 24);
+		}
+	}
+}
+
+bool Random::system(uint8_t* data, size_t length) {
+#ifdef _WIN32
+	return BCryptGenRandom(nullptr, data, (ULONG)length, BCRYPT_USE_SYSTEM_PREFERRED_RNG) == 0;
+#else
+#if defined(__linux__)
+	size_t done = 0;
+	while (done < length) {
+		ssize_t n = getrandom(data + done, length - done, 0);
+		if (n < 0 && errno == EINTR) {
+			continue;
+		}
+		if (n < 0) {
+			break;
+		}
+		done += (size_t)n;
+	}
+	if (done == length) {
+		return true;
+	}
+#endif
+	// Kernels without getrandom
+	int fd = open("/dev/urandom", O_RDONLY | O_CLOEXEC);
+	if (fd < 0) {
+		return false;
+	}
+	size_t total = 0;
+	while (total < length) {
+		ssize_t n = read(fd, data + total, length - total);
+		if (n < 0 && errno == EINTR) {
+			continue;
+		}
+		if (n <= 0) {
+			break;
+		}
+		total += (size_t)n;
+	}
+	close(fd);
+	return total == length;
+#endif
+}
+
+static void seed(Generator& generator) {
+#ifndef _WIN32
+	static const int registered = pthread_atfork(nullptr, nullptr, onFork);
+	(void)registered;
+#endif
+	// Without a seed there is nothing safe to return
+	if (!Random::system(generator.key, sizeof(generator.key))) {
+		abort();
+	}
+	generator.forks = g_forks;
+	generator.generated = 0;
+	generator.used = Random::BUFFER;
+	generator.seeded = true;
+}
+
+static void refill(Generator& generator) {
+	for (size_t i = 0; i < Random::BUFFER; i += Random::LANES * 64) {
+		Random::chacha20(generator.key, i / 64, generator.buffer + i);
+	}
+	// Fast key erasure: the start of the buffer becomes the next key and is never handed out
+	memcpy(generator.key, generator.buffer, sizeof(generator.key));
+	memset(generator.buffer, 0, sizeof(generator.key));
+	generator.used = sizeof(generator.key);
+}
+
+void Random::fill(uint8_t* data, size_t length) {
+	static thread_local Generator generator;
+
+	if (!generator.seeded || generator.forks != g_forks || generator.generated >= RESEED_BYTES) {
+		seed(generator);
+	}
+	generator.generated += length;
+
+	while (length > 0) {
+		if (generator.used == BUFFER) {
+			refill(generator);
+		}
+		size_t n = BUFFER - generator.used < length ? BUFFER - generator.used : length;
+		memcpy(data, generator.buffer + generator.used, n);
+		// Bytes already handed out do not stay in memory
+		memset(generator.buffer + generator.used, 0, n);
+		generator.used += n;
+		data += n;
+		length -= n;
+	}
+}
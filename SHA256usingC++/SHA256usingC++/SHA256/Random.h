@@ -0,0 +1,31 @@
+#ifndef RANDOM_H
+#define RANDOM_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Cryptographically secure random bytes for keys, IVs and nonces.
+//
+// Every thread runs its own ChaCha20 generator, seeded from the operating system
+// (getrandom, or BCryptGenRandom on Windows), so callers never contend or make a system call
+// per request. Output is produced a buffer at a time by a multi-block kernel, and the first
+// 32 bytes of each buffer replace the key so earlier output cannot be recomputed from the
+// state. A thread reseeds from the OS after RESEED_BYTES and in the child after fork().
+class Random {
+
+public:
+	static constexpr size_t LANES = 8;
+	static constexpr size_t BUFFER = 8 * LANES * 64;
+	static constexpr uint64_t RESEED_BYTES = (uint64_t)1 << 30;
+
+	static void fill(uint8_t* data, size_t length);
+
+	// ChaCha20 blocks counter .. counter + LANES - 1 under key with an all-zero nonce,
+	// 64 * LANES bytes of keystream.
+	static void chacha20(const uint8_t* key, uint64_t counter, uint8_t* out);
+
+	// Reads length bytes from the operating system generator.
+	static bool system(uint8_t* data, size_t length);
+};
+
+#endif
@@ -0,0 +1,283 @@
+#include "RecordHasher.h"
+#include "MappedFile.h"
+#include "SHA256Batch.h"
+#include <algorithm>
+#include <cstdio>
+#include <thread>
+#include <utility>
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define RECORD_SSE2
+#include <emmintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+RecordHasher::RecordHasher(Format format, size_t threads)
+	: m_format(format), m_threads(threads ? threads : 1), m_read(0), m_written(0), m_records(0), m_writing(false), m_finished(false), m_out(nullptr) {
+}
+
+static inline uint32_t be32(const uint8_t* p) {
+	return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | (uint32_t)p[3];
+}
+
+#ifdef RECORD_SSE2
+static inline unsigned lowestBit(uint32_t mask) {
+#ifdef _MSC_VER
+	unsigned long index;
+	_BitScanForward(&index, mask);
+	return (unsigned)index;
+#else
+	return (unsigned)__builtin_ctz(mask);
+#endif
+}
+#endif
+
+void RecordHasher::findNewlines(const uint8_t* data, size_t length, uint64_t base, std::vector<uint64_t>& starts) {
+	size_t i = 0;
+
+#ifdef RECORD_SSE2
+	// 32 bytes compared per step; lines are usually longer than that, so most steps find no bit at all
+	const __m128i newline = _mm_set1_epi8('\n');
+	for (; i + 32 <= length; i += 32) {
+		__m128i lo = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(data + i)), newline);
+		__m128i hi = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(data + i + 16)), newline);
+		uint32_t mask = (uint32_t)_mm_movemask_epi8(lo) | ((uint32_t)_mm_movemask_epi8(hi) << 16);
+		while (mask) {
+			starts.push_back(base + i + lowestBit(mask) + 1);
+			mask &= mask - 1;
+		}
+	}
+#endif
+
+	for (; i < length; i++) {
+		if (data[i] == '\n') {
+			starts.push_back(base + i + 1);
+		}
+	}
+}
+
+// Length of the leading run of whole records. At the end of the input a last line needs no '\n',
+// while a length-prefixed record still has to be complete.
+size_t RecordHasher::cut(const uint8_t* data, size_t length, bool end) const {
+	if (m_format == LINES) {
+		if (end) {
+			return length;
+		}
+		while (length > 0 && data[length - 1] != '\n') {
+			length--;
+		}
+		return length;
+	}
+
+	size_t position = 0;
+	while (length - position >= 4) {
+		uint64_t size = 4 + (uint64_t)be32(data + position);
+		if (size > length - position) {
+			break;
+		}
+		position += (size_t)size;
+	}
+	return position;
+}
+
+// Digests every record of a chunk into its output, returns the record count
+uint64_t RecordHasher::hash(Chunk& chunk) const {
+	static const char digits[] = "0123456789abcdef";
+
+	// Offsets point at the start of each record, and the bytes before the next one (its '\n' or
+	// the next length prefix) are left out as the arena trailer. A last line without '\n' gets a
+	// virtual one past the end, which is never read.
+	std::vector<uint64_t> starts;
+	size_t trailer;
+	if (m_format == LINES) {
+		trailer = 1;
+		starts.push_back(0);
+		findNewlines(chunk.data, chunk.length, 0, starts);
+		if (chunk.length > 0 && chunk.data[chunk.length - 1] != '\n') {
+			starts.push_back(chunk.length + 1);
+		}
+	}
+	else {
+		trailer = 4;
+		for (size_t position = 0; position < chunk.length; position += 4 + be32(chunk.data + position)) {
+			starts.push_back(position + 4);
+		}
+		starts.push_back(chunk.length + 4);
+	}
+
+	size_t count = starts.size() - 1;
+	std::vector<uint8_t> digests(count * 32);
+	SHA256Batch::hashArena(chunk.data, starts.data(), count, digests.data(), trailer);
+
+	chunk.output.resize(count * 65);
+	char* line = &chunk.output[0];
+	for (size_t i = 0; i < count; i++, line += 65) {
+		for (size_t j = 0; j < 32; j++) {
+			line[j * 2] = digits[digests[i * 32 + j] >> 4];
+			line[j * 2 + 1] = digits[digests[i * 32 + j] & 15];
+		}
+		line[64] = '\n';
+	}
+	return count;
+}
+
+void RecordHasher::submit(Chunk& chunk) {
+	if (m_threads == 1) {
+		m_records += hash(chunk);
+		m_out->write(chunk.output.data(), (std::streamsize)chunk.output.size());
+		return;
+	}
+
+	// Reading stays at most a window of chunks ahead of the output
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_changed.wait(lock, [this]() { return m_read - m_written < m_window.size(); });
+	chunk.sequence = m_read++;
+	m_pending.push_back(std::move(chunk));
+	m_changed.notify_all();
+}
+
+void RecordHasher::worker() {
+	for (;;) {
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_changed.wait(lock, [this]() { return !m_pending.empty() || m_finished; });
+		if (m_pending.empty()) {
+			return;
+		}
+		Chunk chunk = std::move(m_pending.front());
+		m_pending.pop_front();
+		lock.unlock();
+
+		uint64_t records = hash(chunk);
+		finish(chunk, records);
+	}
+}
+
+// Parks a hashed chunk in the reorder window. Whichever worker finds the next chunk in order
+// ready becomes the writer and drains the window until it reaches a gap.
+void RecordHasher::finish(Chunk& chunk, uint64_t records) {
+	std::unique_lock<std::mutex> lock(m_mutex);
+	size_t slot = (size_t)(chunk.sequence % m_window.size());
+	m_window[slot] = std::move(chunk);
+	m_done[slot] = true;
+	m_records += records;
+	if (m_writing) {
+		return;
+	}
+
+	m_writing = true;
+	for (;;) {
+		slot = (size_t)(m_written % m_window.size());
+		if (!m_done[slot]) {
+			break;
+		}
+		Chunk next = std::move(m_window[slot]);
+		m_done[slot] = false;
+		lock.unlock();
+
+		m_out->write(next.output.data(), (std::streamsize)next.output.size());
+		next = Chunk();
+
+		lock.lock();
+		m_written++;
+		m_changed.notify_all();
+	}
+	m_writing = false;
+}
+
+int64_t RecordHasher::run(const std::string& path, std::ostream& out) {
+	m_out = &out;
+	m_read = m_written = m_records = 0;
+	m_writing = m_finished = false;
+	m_window.assign(2 * m_threads, Chunk());
+	m_done.assign(2 * m_threads, false);
+
+	std::vector<std::thread> workers;
+	for (size_t i = 0; m_threads > 1 && i < m_threads; i++) {
+		workers.emplace_back(&RecordHasher::worker, this);
+	}
+
+	// Declared out here so the mapping outlives the workers hashing chunks that point into it
+	MappedFile input;
+	bool ok = true;
+	if (path == "-") {
+#ifdef _WIN32
+		_setmode(_fileno(stdin), _O_BINARY);
+#endif
+		// Whole records go out as a chunk, the partial one at the end is carried into the next buffer
+		std::vector<uint8_t> buffer(CHUNK);
+		size_t filled = 0;
+		bool end = false;
+		while (ok && !end) {
+			filled += fread(buffer.data() + filled, 1, buffer.size() - filled, stdin);
+			end = filled < buffer.size();
+			if (end && ferror(stdin)) {
+				ok = false;
+				break;
+			}
+
+			size_t complete = cut(buffer.data(), filled, end);
+			if (complete == 0 && !end) { // A record longer than the buffer
+				buffer.resize(buffer.size() * 2);
+				continue;
+			}
+			ok = complete == filled || !end;
+			if (complete == 0) {
+				break;
+			}
+
+			size_t rest = filled - complete;
+			std::vector<uint8_t> next(std::max(CHUNK, 2 * rest));
+			std::copy(buffer.begin() + complete, buffer.begin() + filled, next.begin());
+
+			Chunk chunk;
+			chunk.storage = std::move(buffer);
+			chunk.data = chunk.storage.data();
+			chunk.length = complete;
+			submit(chunk);
+
+			buffer = std::move(next);
+			filled = rest;
+		}
+	}
+	else {
+		ok = input.open(path, false);
+		uint64_t size = input.size();
+		uint64_t position = 0;
+		while (ok && position < size) {
+			size_t length = (size_t)std::min<uint64_t>(CHUNK, size - position);
+			size_t complete;
+			while ((complete = cut(input.data() + position, length, position + length == size)) == 0 && position + length < size) {
+				length = (size_t)std::min<uint64_t>(2 * (uint64_t)length, size - position);
+			}
+			if (complete == 0) {
+				ok = false;
+				break;
+			}
+
+			Chunk chunk;
+			chunk.data = input.data() + position;
+			chunk.length = complete;
+			submit(chunk);
+			position += complete;
+		}
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_finished = true;
+	}
+	m_changed.notify_all();
+	for (auto& t : workers) {
+		t.join();
+	}
+
+	out.flush();
+	return ok && out ? (int64_t)m_records : -1;
+}
@@ -0,0 +1,68 @@
+#ifndef RECORD_HASHER_H
+#define RECORD_HASHER_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// One SHA-256 per record of a stream, printed as a hex line per record in input order.
+// Records are lines (the '\n' is not hashed, a last line without one still counts) or
+// length-prefixed (a 4-byte big endian length, then the record).
+//
+// Files are mapped, stdin is read CHUNK bytes at a time. The input is cut into chunks of whole
+// records; each chunk is scanned for boundaries and its records hashed eight at a time on the
+// multi-buffer kernel by a pool of threads. Chunks finish out of order, so finished ones wait in
+// a reorder window until every earlier chunk has been written; the window also bounds how far
+// reading can run ahead of the output.
+class RecordHasher {
+
+public:
+	enum Format { LINES, PREFIXED };
+
+	static constexpr size_t CHUNK = 4 * 1024 * 1024;
+
+	RecordHasher(Format format, size_t threads);
+
+	// Hashes every record of path ("-" for stdin), returns the record count or -1 if the input
+	// cannot be read or ends inside a length-prefixed record.
+	int64_t run(const std::string& path, std::ostream& out);
+
+	// Appends base + i + 1 to starts for every '\n' at data[i], i < length.
+	static void findNewlines(const uint8_t* data, size_t length, uint64_t base, std::vector<uint64_t>& starts);
+
+private:
+	struct Chunk {
+		uint64_t sequence;
+		const uint8_t* data;
+		size_t length;
+		std::vector<uint8_t> storage; // Owns data when read from stdin, empty when mapped
+		std::string output;
+	};
+
+	Format m_format;
+	size_t m_threads;
+
+	std::mutex m_mutex;
+	std::condition_variable m_changed;
+	std::deque<Chunk> m_pending;
+	std::vector<Chunk> m_window;
+	std::vector<bool> m_done;
+	uint64_t m_read;
+	uint64_t m_written;
+	uint64_t m_records;
+	bool m_writing;
+	bool m_finished;
+	std::ostream* m_out;
+
+	size_t cut(const uint8_t* data, size_t length, bool end) const;
+	uint64_t hash(Chunk& chunk) const;
+	void submit(Chunk& chunk);
+	void worker();
+	void finish(Chunk& chunk, uint64_t records);
+};
+
+#endif
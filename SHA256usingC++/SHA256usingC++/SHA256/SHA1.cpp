@@ -0,0 +1,232 @@
+#include "SHA1.h"
+#include <cstring>
+#include <sstream>
+#include <iomanip>
+
+#ifdef SHA1_HARDWARE
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+static inline uint32_t rotl(uint32_t x, uint32_t n) {
+	return (x << n) | (x >> (32 - n));
+}
+
+SHA1::SHA1() : m_blocklen(0), m_bitlen(0) {
+	m_state[0] = 0x67452301;
+	m_state[1] = 0xefcdab89;
+	m_state[2] = 0x98badcfe;
+	m_state[3] = 0x10325476;
+	m_state[4] = 0xc3d2e1f0;
+}
+
+void SHA1::update(const uint8_t* data, size_t length) {
+	// Whole blocks are compressed straight from the input once the buffer is empty
+	if (m_blocklen == 0 && length >= 64) {
+		size_t blocks = length / 64;
+		compress(m_state, data, blocks);
+		m_bitlen += (uint64_t)blocks * 512;
+		data += blocks * 64;
+		length -= blocks * 64;
+	}
+
+	while (length > 0) {
+		size_t take = 64 - m_blocklen < length ? 64 - m_blocklen : length;
+		memcpy(m_data + m_blocklen, data, take);
+		m_blocklen += (uint32_t)take;
+		data += take;
+		length -= take;
+
+		if (m_blocklen == 64) {
+			compress(m_state, m_data, 1);
+
+			// End of the block
+			m_bitlen += 512;
+			m_blocklen = 0;
+		}
+	}
+}
+
+void SHA1::update(const std::string& data) {
+	update(reinterpret_cast<const uint8_t*> (data.c_str()), data.size());
+}
+
+void SHA1::digest(uint8_t* hash) {
+	pad();
+	revert(hash);
+}
+
+bool SHA1::accelerated() {
+#ifdef SHA1_HARDWARE
+#ifdef _MSC_VER
+	static const bool available = [] {
+		int info[4];
+		__cpuid(info, 0);
+		if (info[0] < 7) {
+			return false;
+		}
+		__cpuidex(info, 7, 0);
+		bool sha = (info[1] & (1 << 29)) != 0;
+		__cpuid(info, 1);
+		return sha && (info[2] & (1 << 19)) && (info[2] & (1 << 9));
+	}();
+#else
+	static const bool available = __builtin_cpu_supports("sha") && __builtin_cpu_supports("sse4.1");
+#endif
+	return available;
+#else
+	return false;
+#endif
+}
+
+void SHA1::compress(uint32_t state[5], const uint8_t* data, size_t blocks) {
+#ifdef SHA1_HARDWARE
+	if (accelerated()) {
+		compressHardware(state, data, blocks);
+		return;
+	}
+#endif
+	compressPortable(state, data, blocks);
+}
+
+void SHA1::compressPortable(uint32_t state[5], const uint8_t* data, size_t blocks) {
+	for (; blocks > 0; blocks--, data += 64) {
+		uint32_t w[80];
+		for (uint8_t i = 0, j = 0; i < 16; i++, j += 4) {
+			w[i] = ((uint32_t)data[j] << 24) | ((uint32_t)data[j + 1] << 16) | ((uint32_t)data[j + 2] << 8) | data[j + 3];
+		}
+		for (uint8_t i = 16; i < 80; i++) {
+			w[i] = rotl(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+		}
+
+		// One loop per round function keeps the rounds free of branches
+		uint32_t a = state[0], b = state[1], c = state[2], d = state[3], e = state[4], t;
+		for (uint8_t i = 0; i < 20; i++) {
+			t = rotl(a, 5) + ((b & c) | (~b & d)) + e + 0x5a827999 + w[i];
+			e = d; d = c; c = rotl(b, 30); b = a; a = t;
+		}
+		for (uint8_t i = 20; i < 40; i++) {
+			t = rotl(a, 5) + (b ^ c ^ d) + e + 0x6ed9eba1 + w[i];
+			e = d; d = c; c = rotl(b, 30); b = a; a = t;
+		}
+		for (uint8_t i = 40; i < 60; i++) {
+			t = rotl(a, 5) + ((b & c) | (b & d) | (c & d)) + e + 0x8f1bbcdc + w[i];
+			e = d; d = c; c = rotl(b, 30); b = a; a = t;
+		}
+		for (uint8_t i = 60; i < 80; i++) {
+			t = rotl(a, 5) + (b ^ c ^ d) + e + 0xca62c1d6 + w[i];
+			e = d; d = c; c = rotl(b, 30); b = a; a = t;
+		}
+
+		state[0] += a;
+		state[1] += b;
+		state[2] += c;
+		state[3] += d;
+		state[4] += e;
+	}
+}
+
+#ifdef SHA1_HARDWARE
+
+// Four rounds with round function F; e holds the E input for the next group
+template <int F>
+static inline SHA1_HARDWARE_TARGET void rounds(__m128i& abcd, __m128i& e, __m128i w) {
+	__m128i next = _mm_sha1nexte_epu32(e, w);
+	e = abcd;
+	abcd = _mm_sha1rnds4_epu32(abcd, next, F);
+}
+
+// The next four schedule words from the previous sixteen
+static inline SHA1_HARDWARE_TARGET __m128i schedule(__m128i w0, __m128i w1, __m128i w2, __m128i w3) {
+	return _mm_sha1msg2_epu32(_mm_xor_si128(_mm_sha1msg1_epu32(w0, w1), w2), w3);
+}
+
+void SHA1::compressHardware(uint32_t state[5], const uint8_t* data, size_t blocks) {
+	const __m128i swap = _mm_set_epi64x(0x0001020304050607ULL, 0x08090a0b0c0d0e0fULL);
+	__m128i abcd = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i*)state), 0x1b);
+	__m128i e0 = _mm_set_epi32((int)state[4], 0, 0, 0);
+
+	for (; blocks > 0; blocks--, data += 64) {
+		__m128i abcdSave = abcd, eSave = e0;
+		__m128i w0 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)data), swap);
+		__m128i w1 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(data + 16)), swap);
+		__m128i w2 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(data + 32)), swap);
+		__m128i w3 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(data + 48)), swap);
+
+		// The first group adds E directly, later ones rotate it in with sha1nexte
+		__m128i e = abcd;
+		abcd = _mm_sha1rnds4_epu32(abcd, _mm_add_epi32(e0, w0), 0);
+		rounds<0>(abcd, e, w1);
+		rounds<0>(abcd, e, w2);
+		rounds<0>(abcd, e, w3);
+		w0 = schedule(w0, w1, w2, w3); rounds<0>(abcd, e, w0);
+		w1 = schedule(w1, w2, w3, w0); rounds<1>(abcd, e, w1);
+		w2 = schedule(w2, w3, w0, w1); rounds<1>(abcd, e, w2);
+		w3 = schedule(w3, w0, w1, w2); rounds<1>(abcd, e, w3);
+		w0 = schedule(w0, w1, w2, w3); rounds<1>(abcd, e, w0);
+		w1 = schedule(w1, w2, w3, w0); rounds<1>(abcd, e, w1);
+		w2 = schedule(w2, w3, w0, w1); rounds<2>(abcd, e, w2);
+		w3 = schedule(w3, w0, w1, w2); rounds<2>(abcd, e, w3);
+		w0 = schedule(w0, w1, w2, w3); rounds<2>(abcd, e, w0);
+		w1 = schedule(w1, w2, w3, w0); rounds<2>(abcd, e, w1);
+		w2 = schedule(w2, w3, w0, w1); rounds<2>(abcd, e, w2);
+		w3 = schedule(w3, w0, w1, w2); rounds<3>(abcd, e, w3);
+		w0 = schedule(w0, w1, w2, w3); rounds<3>(abcd, e, w0);
+		w1 = schedule(w1, w2, w3, w0); rounds<3>(abcd, e, w1);
+		w2 = schedule(w2, w3, w0, w1); rounds<3>(abcd, e, w2);
+		w3 = schedule(w3, w0, w1, w2); rounds<3>(abcd, e, w3);
+
+		e0 = _mm_sha1nexte_epu32(e, eSave);
+		abcd = _mm_add_epi32(abcd, abcdSave);
+	}
+
+	_mm_storeu_si128((__m128i*)state, _mm_shuffle_epi32(abcd, 0x1b));
+	state[4] = (uint32_t)_mm_extract_epi32(e0, 3);
+}
+
+#endif
+
+void SHA1::pad() {
+	uint64_t i = m_blocklen;
+	uint8_t end = m_blocklen < 56 ? 56 : 64;
+
+	m_data[i++] = 0x80; // Append a bit 1
+	while (i < end) {
+		m_data[i++] = 0x00; // Pad with zeros
+	}
+
+	if (m_blocklen >= 56) {
+		compress(m_state, m_data, 1);
+		memset(m_data, 0, 56);
+	}
+
+	// Append to the padding the total message's length in bits and compress.
+	m_bitlen += m_blocklen * 8;
+	for (uint8_t j = 0; j < 8; j++) {
+		m_data[63 - j] = (uint8_t)(m_bitlen >> (j * 8));
+	}
+	compress(m_state, m_data, 1);
+}
+
+void SHA1::revert(uint8_t* hash) {
+	// SHA uses big endian byte ordering
+	for (uint8_t j = 0; j < 5; j++) {
+		hash[j * 4] = (uint8_t)(m_state[j] >> 24);
+		hash[j * 4 + 1] = (uint8_t)(m_state[j] >> 16);
+		hash[j * 4 + 2] = (uint8_t)(m_state[j] >> 8);
+		hash[j * 4 + 3] = (uint8_t)m_state[j];
+	}
+}
+
+std::string SHA1::toString(const uint8_t* digest) {
+	std::stringstream s;
+	s << std::setfill('0') << std::hex;
+
+	for (uint8_t i = 0; i < 20; i++) {
+		s << std::setw(2) << (unsigned int)digest[i];
+	}
+
+	return s.str();
+}
@@ -0,0 +1,56 @@
+#ifndef SHA1_H
+#define SHA1_H
+
+#include <string>
+#include <cstdint>
+
+// SHA-NI is used when the CPU has it. Define SHA1_NO_HARDWARE to build the portable code only.
+#if (defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)) && !defined(SHA1_NO_HARDWARE)
+#define SHA1_HARDWARE 1
+#if defined(__GNUC__)
+#define SHA1_HARDWARE_TARGET __attribute__((target("sha,sse4.1")))
+#else
+#define SHA1_HARDWARE_TARGET
+#endif
+#endif
+
+// SHA-1 with the same interface as SHA256. Only for the legacy formats that still require it
+// (RSA-OAEP with SHA-1, PBKDF2WithHmacSHA1); it is not collision resistant.
+class SHA1 {
+
+public:
+	static constexpr size_t SIZE = 20;
+	static constexpr size_t BLOCK = 64;
+
+	SHA1();
+	void update(const uint8_t* data, size_t length);
+	void update(const std::string& data);
+	// Writes the 20 byte digest into hash.
+	void digest(uint8_t* hash);
+
+	static std::string toString(const uint8_t* digest);
+
+	// Runs the compression function over whole 64 byte blocks. For callers that lay out
+	// fixed-length padded blocks themselves, such as the PBKDF2 inner loop.
+	static void compress(uint32_t state[5], const uint8_t* data, size_t blocks);
+
+	// True when the SHA extensions are available.
+	static bool accelerated();
+
+private:
+	template <typename> friend class BasicHMAC;
+
+	uint8_t  m_data[64];
+	uint32_t m_blocklen;
+	uint64_t m_bitlen;
+	uint32_t m_state[5]; //A, B, C, D, E
+
+	static void compressPortable(uint32_t state[5], const uint8_t* data, size_t blocks);
+#ifdef SHA1_HARDWARE
+	SHA1_HARDWARE_TARGET static void compressHardware(uint32_t state[5], const uint8_t* data, size_t blocks);
+#endif
+	void pad();
+	void revert(uint8_t* hash);
+};
+
+#endif
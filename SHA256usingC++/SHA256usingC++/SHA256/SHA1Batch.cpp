@@ -0,0 +1,180 @@
+#include "SHA1Batch.h"
+#include "SHA1.h"
+#include <cstring>
+
+static inline uint32_t rotl(uint32_t x, uint32_t n) {
+	return (x << n) | (x >> (32 - n));
+}
+
+// One SHA-NI compression is several times cheaper than a lane group's share, so with the
+// extensions messages simply go one after another
+static void hashSequential(const uint8_t* data, size_t length, uint8_t* out) {
+	SHA1 sha;
+	sha.update(data, length);
+	sha.digest(out);
+}
+
+void SHA1Batch::hash(const uint8_t* const* data, const size_t* lengths, size_t count, uint8_t* out) {
+	if (SHA1::accelerated()) {
+		for (size_t i = 0; i < count; i++) {
+			hashSequential(data[i], lengths[i], out + 20 * i);
+		}
+		return;
+	}
+
+	uint8_t* outputs[LANES];
+
+	for (size_t i = 0; i < count; i += LANES) {
+		size_t n = count - i < LANES ? count - i : LANES;
+		for (size_t l = 0; l < n; l++) {
+			outputs[l] = out + 20 * (i + l);
+		}
+		hashGroup(data + i, lengths + i, n, outputs);
+	}
+}
+
+void SHA1Batch::hashArena(const uint8_t* arena, const uint32_t* offsets, size_t count, uint8_t* out) {
+	if (SHA1::accelerated()) {
+		for (size_t i = 0; i < count; i++) {
+			hashSequential(arena + offsets[i], offsets[i + 1] - offsets[i], out + 20 * i);
+		}
+		return;
+	}
+
+	const uint8_t* data[LANES];
+	size_t lengths[LANES];
+	uint8_t* outputs[LANES];
+
+	for (size_t i = 0; i < count; i += LANES) {
+		size_t n = count - i < LANES ? count - i : LANES;
+		for (size_t l = 0; l < n; l++) {
+			data[l] = arena + offsets[i + l];
+			lengths[l] = offsets[i + l + 1] - offsets[i + l];
+			outputs[l] = out + 20 * (i + l);
+		}
+		hashGroup(data, lengths, n, outputs);
+	}
+}
+
+void SHA1Batch::hashGroup(const uint8_t* const* data, const size_t* lengths, size_t count, uint8_t* const* out) {
+	static const uint32_t init[5] = { 0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476, 0xc3d2e1f0 };
+
+	uint32_t state[5][LANES];
+	uint32_t block[16][LANES];
+	uint32_t mask[LANES];
+	uint8_t tail[LANES][128];
+	size_t full[LANES], blocks[LANES], maxBlocks = 0;
+
+	for (size_t l = 0; l < LANES; l++) {
+		for (uint8_t i = 0; i < 5; i++) {
+			state[i][l] = init[i];
+		}
+
+		if (l >= count) { // Unused lanes run on zero blocks and are never committed
+			full[l] = blocks[l] = 0;
+			memset(tail[l], 0, 64);
+			continue;
+		}
+
+		// Whole blocks are read in place, only the remainder and padding are copied
+		size_t rest = lengths[l] % 64;
+		uint64_t bitlen = (uint64_t)lengths[l] * 8;
+		size_t tailBlocks = rest < 56 ? 1 : 2;
+
+		full[l] = lengths[l] / 64;
+		blocks[l] = full[l] + tailBlocks;
+		memset(tail[l], 0, 128);
+		memcpy(tail[l], data[l] + full[l] * 64, rest);
+		tail[l][rest] = 0x80;
+		for (uint8_t i = 0; i < 8; i++) {
+			tail[l][tailBlocks * 64 - 1 - i] = (uint8_t)(bitlen >> (i * 8));
+		}
+
+		if (blocks[l] > maxBlocks) {
+			maxBlocks = blocks[l];
+		}
+	}
+
+	for (size_t b = 0; b < maxBlocks; b++) {
+		for (size_t l = 0; l < LANES; l++) {
+			const uint8_t* src = tail[l];
+			if (b < full[l]) {
+				src = data[l] + b * 64;
+			}
+			else if (b < blocks[l]) {
+				src = tail[l] + (b - full[l]) * 64;
+			}
+
+			mask[l] = b < blocks[l] ? 0xffffffff : 0;
+			for (uint8_t i = 0, j = 0; i < 16; i++, j += 4) {
+				block[i][l] = ((uint32_t)src[j] << 24) | ((uint32_t)src[j + 1] << 16) | ((uint32_t)src[j + 2] << 8) | src[j + 3];
+			}
+		}
+
+		compress(state, block, mask);
+	}
+
+	// SHA uses big endian byte ordering
+	for (size_t l = 0; l < count; l++) {
+		for (uint8_t i = 0; i < 5; i++) {
+			out[l][i * 4] = (uint8_t)(state[i][l] >> 24);
+			out[l][i * 4 + 1] = (uint8_t)(state[i][l] >> 16);
+			out[l][i * 4 + 2] = (uint8_t)(state[i][l] >> 8);
+			out[l][i * 4 + 3] = (uint8_t)state[i][l];
+		}
+	}
+}
+
+void SHA1Batch::compress(uint32_t state[5][LANES], const uint32_t block[16][LANES], const uint32_t* mask) {
+	// Round counters are size_t: narrow loop counters keep GCC from vectorising across lanes
+	uint32_t w[80][LANES];
+	uint32_t a[LANES], b[LANES], c[LANES], d[LANES], e[LANES];
+
+	for (size_t i = 0; i < 16; i++) {
+		for (size_t l = 0; l < LANES; l++) {
+			w[i][l] = block[i][l];
+		}
+	}
+	for (size_t i = 16; i < 80; i++) {
+		for (size_t l = 0; l < LANES; l++) {
+			w[i][l] = rotl(w[i - 3][l] ^ w[i - 8][l] ^ w[i - 14][l] ^ w[i - 16][l], 1);
+		}
+	}
+
+	for (size_t l = 0; l < LANES; l++) {
+		a[l] = state[0][l]; b[l] = state[1][l]; c[l] = state[2][l]; d[l] = state[3][l]; e[l] = state[4][l];
+	}
+
+	// One loop per round function keeps the rounds free of branches
+	for (size_t i = 0; i < 20; i++) {
+		for (size_t l = 0; l < LANES; l++) {
+			uint32_t t = rotl(a[l], 5) + ((b[l] & c[l]) | (~b[l] & d[l])) + e[l] + 0x5a827999 + w[i][l];
+			e[l] = d[l]; d[l] = c[l]; c[l] = rotl(b[l], 30); b[l] = a[l]; a[l] = t;
+		}
+	}
+	for (size_t i = 20; i < 40; i++) {
+		for (size_t l = 0; l < LANES; l++) {
+			uint32_t t = rotl(a[l], 5) + (b[l] ^ c[l] ^ d[l]) + e[l] + 0x6ed9eba1 + w[i][l];
+			e[l] = d[l]; d[l] = c[l]; c[l] = rotl(b[l], 30); b[l] = a[l]; a[l] = t;
+		}
+	}
+	for (size_t i = 40; i < 60; i++) {
+		for (size_t l = 0; l < LANES; l++) {
+			uint32_t t = rotl(a[l], 5) + ((b[l] & c[l]) | (b[l] & d[l]) | (c[l] & d[l])) + e[l] + 0x8f1bbcdc + w[i][l];
+			e[l] = d[l]; d[l] = c[l]; c[l] = rotl(b[l], 30); b[l] = a[l]; a[l] = t;
+		}
+	}
+	for (size_t i = 60; i < 80; i++) {
+		for (size_t l = 0; l < LANES; l++) {
+			uint32_t t = rotl(a[l], 5) + (b[l] ^ c[l] ^ d[l]) + e[l] + 0xca62c1d6 + w[i][l];
+			e[l] = d[l]; d[l] = c[l]; c[l] = rotl(b[l], 30); b[l] = a[l]; a[l] = t;
+		}
+	}
+
+	// Lanes whose message is already finished keep their state
+	for (size_t l = 0; l < LANES; l++) {
+		state[0][l] += a[l] & mask[l]; state[1][l] += b[l] & mask[l];
+		state[2][l] += c[l] & mask[l]; state[3][l] += d[l] & mask[l];
+		state[4][l] += e[l] & mask[l];
+	}
+}
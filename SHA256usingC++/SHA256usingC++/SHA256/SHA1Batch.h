@@ -0,0 +1,29 @@
+#ifndef SHA1_BATCH_H
+#define SHA1_BATCH_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Multi-buffer SHA-1, laid out like SHA256Batch: one message per lane, lane loops innermost
+// so the compiler can map them onto SIMD registers. On CPUs with the SHA extensions hash and
+// hashArena use SHA-NI one message at a time instead, which is faster still.
+class SHA1Batch {
+
+public:
+	static constexpr size_t LANES = 8;
+
+	// Hashes data[i] (lengths[i] bytes) into out + 20 * i for every i < count.
+	static void hash(const uint8_t* const* data, const size_t* lengths, size_t count, uint8_t* out);
+
+	// Item i is arena[offsets[i], offsets[i + 1]); digests land at out + 20 * i.
+	static void hashArena(const uint8_t* arena, const uint32_t* offsets, size_t count, uint8_t* out);
+
+	// One block per lane, given as big endian words. Lanes with a zero mask keep their state.
+	// Fixed-length callers (PBKDF2 feeds back 20 byte digests) build the words directly.
+	static void compress(uint32_t state[5][LANES], const uint32_t block[16][LANES], const uint32_t* mask);
+
+private:
+	static void hashGroup(const uint8_t* const* data, const size_t* lengths, size_t count, uint8_t* const* out);
+};
+
+#endif
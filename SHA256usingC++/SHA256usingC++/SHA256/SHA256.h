@@ -4,18 +4,28 @@
 #include <string>
 #include<stdio.h>
 #include <array>
+#include <cstdint>
 
+// Every step from construction to digest(uint8_t*) is constexpr, so the same code also hashes
+// literals at compile time (see ConstexprSHA).
 class SHA256 {
 
 public:
-	SHA256();
-	void update(const uint8_t* data, size_t length);
+	static constexpr size_t SIZE = 32;
+	static constexpr size_t BLOCK = 64;
+
+	constexpr SHA256();
+	constexpr void update(const uint8_t* data, size_t length);
 	void update(const std::string& data);
 	uint8_t* digest();
+	// Writes the 32 byte digest into hash instead of allocating it.
+	constexpr void digest(uint8_t* hash);
 
 	static std::string toString(const uint8_t* digest);
 
 private:
+	friend class SHA256Batch;
+
 	uint8_t  m_data[64];
 	uint32_t m_blocklen;
 	uint64_t m_bitlen;
@@ -40,14 +50,159 @@ private:
 		0x90befffa,0xa4506ceb,0xbef9a3f7,0xc67178f2
 	};
 
-	static uint32_t rotr(uint32_t x, uint32_t n);
-	static uint32_t choose(uint32_t e, uint32_t f, uint32_t g);
-	static uint32_t majority(uint32_t a, uint32_t b, uint32_t c);
-	static uint32_t sig0(uint32_t x);
-	static uint32_t sig1(uint32_t x);
-	void transform();
-	void pad();
-	void revert(uint8_t* hash);
+	static constexpr uint32_t rotr(uint32_t x, uint32_t n);
+	static constexpr uint32_t choose(uint32_t e, uint32_t f, uint32_t g);
+	static constexpr uint32_t majority(uint32_t a, uint32_t b, uint32_t c);
+	static constexpr uint32_t sig0(uint32_t x);
+	static constexpr uint32_t sig1(uint32_t x);
+	constexpr void transform(const uint8_t* block);
+	constexpr void pad();
+	constexpr void revert(uint8_t* hash) const;
 };
 
+// constexpr functions must be visible wherever they are called, so the core lives here rather
+// than in SHA256.cpp. Constant evaluation needs every variable initialised, hence the {} below.
+
+constexpr SHA256::SHA256()
+	: m_data{}, m_blocklen(0), m_bitlen(0),
+	m_state{ 0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19 } {
+}
+
+constexpr void SHA256::update(const uint8_t* data, size_t length) {
+	while (length > 0) {
+		// Whole blocks are compressed straight from the input, only the ends are buffered
+		if (m_blocklen == 0 && length >= 64) {
+			transform(data);
+			m_bitlen += 512;
+			data += 64;
+			length -= 64;
+			continue;
+		}
+
+		size_t take = 64 - m_blocklen < length ? 64 - m_blocklen : length;
+		for (size_t i = 0; i < take; i++) {
+			m_data[m_blocklen + i] = data[i];
+		}
+		m_blocklen += (uint32_t)take;
+		data += take;
+		length -= take;
+
+		if (m_blocklen == 64) {
+			transform(m_data);
+
+			// End of the block
+			m_bitlen += 512;
+			m_blocklen = 0;
+		}
+	}
+}
+
+constexpr void SHA256::digest(uint8_t* hash) {
+	pad();
+	revert(hash);
+}
+
+constexpr uint32_t SHA256::rotr(uint32_t x, uint32_t n) {
+	return (x >> n) | (x << (32 - n));
+}
+
+constexpr uint32_t SHA256::choose(uint32_t e, uint32_t f, uint32_t g) {
+	return (e & f) ^ (~e & g);
+}
+
+constexpr uint32_t SHA256::majority(uint32_t a, uint32_t b, uint32_t c) {
+	return (a & (b | c)) | (b & c);
+}
+
+constexpr uint32_t SHA256::sig0(uint32_t x) {
+	return SHA256::rotr(x, 7) ^ SHA256::rotr(x, 18) ^ (x >> 3);
+}
+
+constexpr uint32_t SHA256::sig1(uint32_t x) {
+	return SHA256::rotr(x, 17) ^ SHA256::rotr(x, 19) ^ (x >> 10);
+}
+
+constexpr void SHA256::transform(const uint8_t* block) {
+	uint32_t maj = 0, xorA = 0, ch = 0, xorE = 0, sum = 0, newA = 0, newE = 0, m[64] = {};
+	uint32_t state[8] = {};
+
+	for (uint8_t i = 0, j = 0; i < 16; i++, j += 4) { // Split data in 32 bit blocks for the 16 first words
+		m[i] = ((uint32_t)block[j] << 24) | ((uint32_t)block[j + 1] << 16) | ((uint32_t)block[j + 2] << 8) | (uint32_t)block[j + 3];
+	}
+
+	for (uint8_t k = 16; k < 64; k++) { // Remaining 48 blocks
+		m[k] = SHA256::sig1(m[k - 2]) + m[k - 7] + SHA256::sig0(m[k - 15]) + m[k - 16];
+	}
+
+	for (uint8_t i = 0; i < 8; i++) {
+		state[i] = m_state[i];
+	}
+
+	for (uint8_t i = 0; i < 64; i++) {
+		maj = SHA256::majority(state[0], state[1], state[2]);
+		xorA = SHA256::rotr(state[0], 2) ^ SHA256::rotr(state[0], 13) ^ SHA256::rotr(state[0], 22);
+
+		ch = choose(state[4], state[5], state[6]);
+
+		xorE = SHA256::rotr(state[4], 6) ^ SHA256::rotr(state[4], 11) ^ SHA256::rotr(state[4], 25);
+
+		sum = m[i] + K[i] + state[7] + ch + xorE;
+		newA = xorA + maj + sum;
+		newE = state[3] + sum;
+
+		state[7] = state[6];
+		state[6] = state[5];
+		state[5] = state[4];
+		state[4] = newE;
+		state[3] = state[2];
+		state[2] = state[1];
+		state[1] = state[0];
+		state[0] = newA;
+	}
+
+	for (uint8_t i = 0; i < 8; i++) {
+		m_state[i] += state[i];
+	}
+}
+
+constexpr void SHA256::pad() {
+
+	uint64_t i = m_blocklen;
+	uint8_t end = m_blocklen < 56 ? 56 : 64;
+
+	m_data[i++] = 0x80; // Append a bit 1
+	while (i < end) {
+		m_data[i++] = 0x00; // Pad with zeros
+	}
+
+	if (m_blocklen >= 56) {
+		transform(m_data);
+		for (i = 0; i < 56; i++) {
+			m_data[i] = 0x00;
+		}
+	}
+
+	// Append to the padding the total message's length in bits and transform.
+	m_bitlen += m_blocklen * 8;
+	m_data[63] = (uint8_t)m_bitlen;
+	m_data[62] = (uint8_t)(m_bitlen >> 8);
+	m_data[61] = (uint8_t)(m_bitlen >> 16);
+	m_data[60] = (uint8_t)(m_bitlen >> 24);
+	m_data[59] = (uint8_t)(m_bitlen >> 32);
+	m_data[58] = (uint8_t)(m_bitlen >> 40);
+	m_data[57] = (uint8_t)(m_bitlen >> 48);
+	m_data[56] = (uint8_t)(m_bitlen >> 56);
+	transform(m_data);
+}
+
+constexpr void SHA256::revert(uint8_t* hash) const {
+	// SHA uses big endian byte ordering
+	// Revert all bytes
+	for (uint8_t i = 0; i < 4; i++) {
+		for (uint8_t j = 0; j < 8; j++) {
+			hash[i + (j * 4)] = (m_state[j] >> (24 - i * 8)) & 0x000000ff;
+		}
+	}
+}
+
 #endif
\ No newline at end of file
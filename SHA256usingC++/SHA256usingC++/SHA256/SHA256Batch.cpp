@@ -0,0 +1,207 @@
+#include "SHA256Batch.h"
+#include "SHA256.h"
+#include <cstring>
+#include <vector>
+
+static inline uint32_t rotr(uint32_t x, uint32_t n) {
+	return (x >> n) | (x << (32 - n));
+}
+
+void SHA256Batch::hash(const uint8_t* const* data, const size_t* lengths, size_t count, uint8_t* out) {
+	uint8_t* outputs[LANES];
+
+	for (size_t i = 0; i < count; i += LANES) {
+		size_t n = count - i < LANES ? count - i : LANES;
+		for (size_t l = 0; l < n; l++) {
+			outputs[l] = out + 32 * (i + l);
+		}
+		hashGroup(data + i, lengths + i, n, outputs);
+	}
+}
+
+void SHA256Batch::hashArena(const uint8_t* arena, const uint32_t* offsets, size_t count, uint8_t* out, size_t trailer) {
+	hashArenaImpl(arena, offsets, count, out, trailer);
+}
+
+void SHA256Batch::hashArena(const uint8_t* arena, const uint64_t* offsets, size_t count, uint8_t* out, size_t trailer) {
+	hashArenaImpl(arena, offsets, count, out, trailer);
+}
+
+void SHA256Batch::hashGrouped(const uint8_t* const* data, const size_t* lengths, size_t count, uint8_t* out) {
+	hashByBlocks(count, [data, lengths](size_t i, const uint8_t*& itemData, size_t& length) {
+		itemData = data[i];
+		length = lengths[i];
+	}, out);
+}
+
+template <typename Offset>
+void SHA256Batch::hashArenaImpl(const uint8_t* arena, const Offset* offsets, size_t count, uint8_t* out, size_t trailer) {
+	hashByBlocks(count, [arena, offsets, trailer](size_t i, const uint8_t*& data, size_t& length) {
+		data = arena + offsets[i];
+		length = (size_t)(offsets[i + 1] - offsets[i]) - trailer;
+	}, out);
+}
+
+template <typename Item>
+void SHA256Batch::hashByBlocks(size_t count, Item item, uint8_t* out) {
+	const uint8_t* data[LANES];
+	size_t lengths[LANES];
+	uint8_t* outputs[LANES];
+
+	// Lanes only need the same number of blocks, so a counting sort on the padded block count
+	// (long messages share the last bucket) is enough and stays linear
+	const size_t BUCKETS = 64;
+	size_t start[BUCKETS + 1] = { 0 };
+	std::vector<size_t> order(count);
+	auto bucket = [&item](size_t i) {
+		const uint8_t* data;
+		size_t length;
+		item(i, data, length);
+		size_t blocks = (length + 8) / 64;
+		return blocks < BUCKETS - 1 ? blocks : BUCKETS - 1;
+	};
+
+	for (size_t i = 0; i < count; i++) {
+		start[bucket(i) + 1]++;
+	}
+	for (size_t b = 0; b < BUCKETS; b++) {
+		start[b + 1] += start[b];
+	}
+	for (size_t i = 0; i < count; i++) {
+		order[start[bucket(i)]++] = i;
+	}
+
+	for (size_t i = 0; i < count; i += LANES) {
+		size_t n = count - i < LANES ? count - i : LANES;
+		for (size_t l = 0; l < n; l++) {
+			size_t index = order[i + l];
+			item(index, data[l], lengths[l]);
+			outputs[l] = out + 32 * index;
+		}
+		hashGroup(data, lengths, n, outputs);
+	}
+}
+
+void SHA256Batch::hashGroup(const uint8_t* const* data, const size_t* lengths, size_t count, uint8_t* const* out) {
+	static const uint32_t init[8] = {
+		0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+		0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+	};
+
+	uint32_t state[8][LANES];
+	uint32_t block[16][LANES];
+	uint32_t mask[LANES];
+	uint8_t tail[LANES][128];
+	size_t full[LANES], blocks[LANES], maxBlocks = 0;
+
+	for (size_t l = 0; l < LANES; l++) {
+		for (uint8_t i = 0; i < 8; i++) {
+			state[i][l] = init[i];
+		}
+
+		if (l >= count) { // Unused lanes run on zero blocks and are never committed
+			full[l] = blocks[l] = 0;
+			memset(tail[l], 0, 64);
+			continue;
+		}
+
+		// Whole blocks are read in place, only the remainder and padding are copied
+		size_t rest = lengths[l] % 64;
+		uint64_t bitlen = (uint64_t)lengths[l] * 8;
+		size_t tailBlocks = rest < 56 ? 1 : 2;
+
+		full[l] = lengths[l] / 64;
+		blocks[l] = full[l] + tailBlocks;
+		memset(tail[l], 0, 128);
+		memcpy(tail[l], data[l] + full[l] * 64, rest);
+		tail[l][rest] = 0x80;
+		for (uint8_t i = 0; i < 8; i++) {
+			tail[l][tailBlocks * 64 - 1 - i] = (uint8_t)(bitlen >> (i * 8));
+		}
+
+		if (blocks[l] > maxBlocks) {
+			maxBlocks = blocks[l];
+		}
+	}
+
+	for (size_t b = 0; b < maxBlocks; b++) {
+		for (size_t l = 0; l < LANES; l++) {
+			const uint8_t* src = tail[l];
+			if (b < full[l]) {
+				src = data[l] + b * 64;
+			}
+			else if (b < blocks[l]) {
+				src = tail[l] + (b - full[l]) * 64;
+			}
+
+			mask[l] = b < blocks[l] ? 0xffffffff : 0;
+			for (uint8_t i = 0, j = 0; i < 16; i++, j += 4) {
+				block[i][l] = ((uint32_t)src[j] << 24) | ((uint32_t)src[j + 1] << 16) | ((uint32_t)src[j + 2] << 8) | src[j + 3];
+			}
+		}
+
+		transform(state, block, mask);
+	}
+
+	// SHA uses big endian byte ordering
+	for (size_t l = 0; l < count; l++) {
+		for (uint8_t i = 0; i < 8; i++) {
+			out[l][i * 4] = (uint8_t)(state[i][l] >> 24);
+			out[l][i * 4 + 1] = (uint8_t)(state[i][l] >> 16);
+			out[l][i * 4 + 2] = (uint8_t)(state[i][l] >> 8);
+			out[l][i * 4 + 3] = (uint8_t)state[i][l];
+		}
+	}
+}
+
+void SHA256Batch::transform(uint32_t state[8][LANES], const uint32_t block[16][LANES], const uint32_t* mask) {
+	// Round counters are size_t: narrow loop counters keep GCC from vectorising across lanes
+	uint32_t m[64][LANES];
+	uint32_t a[LANES], b[LANES], c[LANES], d[LANES], e[LANES], f[LANES], g[LANES], h[LANES];
+
+	for (size_t i = 0; i < 16; i++) {
+		for (size_t l = 0; l < LANES; l++) {
+			m[i][l] = block[i][l];
+		}
+	}
+
+	for (size_t k = 16; k < 64; k++) {
+		for (size_t l = 0; l < LANES; l++) {
+			uint32_t s0 = rotr(m[k - 15][l], 7) ^ rotr(m[k - 15][l], 18) ^ (m[k - 15][l] >> 3);
+			uint32_t s1 = rotr(m[k - 2][l], 17) ^ rotr(m[k - 2][l], 19) ^ (m[k - 2][l] >> 10);
+			m[k][l] = s1 + m[k - 7][l] + s0 + m[k - 16][l];
+		}
+	}
+
+	for (size_t l = 0; l < LANES; l++) {
+		a[l] = state[0][l]; b[l] = state[1][l]; c[l] = state[2][l]; d[l] = state[3][l];
+		e[l] = state[4][l]; f[l] = state[5][l]; g[l] = state[6][l]; h[l] = state[7][l];
+	}
+
+	for (size_t i = 0; i < 64; i++) {
+		for (size_t l = 0; l < LANES; l++) {
+			uint32_t maj = (a[l] & (b[l] | c[l])) | (b[l] & c[l]);
+			uint32_t xorA = rotr(a[l], 2) ^ rotr(a[l], 13) ^ rotr(a[l], 22);
+			uint32_t ch = (e[l] & f[l]) ^ (~e[l] & g[l]);
+			uint32_t xorE = rotr(e[l], 6) ^ rotr(e[l], 11) ^ rotr(e[l], 25);
+			uint32_t sum = m[i][l] + SHA256::K[i] + h[l] + ch + xorE;
+
+			h[l] = g[l];
+			g[l] = f[l];
+			f[l] = e[l];
+			e[l] = d[l] + sum;
+			d[l] = c[l];
+			c[l] = b[l];
+			b[l] = a[l];
+			a[l] = xorA + maj + sum;
+		}
+	}
+
+	// Lanes whose message is already finished keep their state
+	for (size_t l = 0; l < LANES; l++) {
+		state[0][l] += a[l] & mask[l]; state[1][l] += b[l] & mask[l];
+		state[2][l] += c[l] & mask[l]; state[3][l] += d[l] & mask[l];
+		state[4][l] += e[l] & mask[l]; state[5][l] += f[l] & mask[l];
+		state[6][l] += g[l] & mask[l]; state[7][l] += h[l] & mask[l];
+	}
+}
@@ -0,0 +1,39 @@
+#ifndef SHA256_BATCH_H
+#define SHA256_BATCH_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Multi-buffer SHA-256: hashes independent messages side by side, one message per lane.
+// The lane loops are kept innermost so the compiler can map them onto SIMD registers.
+class SHA256Batch {
+
+public:
+	static constexpr size_t LANES = 8;
+
+	// Hashes data[i] (lengths[i] bytes) into out + 32 * i for every i < count. Items go into lane
+	// groups in the order given, so a group runs as long as its longest item.
+	static void hash(const uint8_t* const* data, const size_t* lengths, size_t count, uint8_t* out);
+
+	// Same result as hash, but items of mixed lengths are first grouped by block count, as in
+	// hashArena, so one long item does not hold up seven short ones. Allocates the order once per call.
+	static void hashGrouped(const uint8_t* const* data, const size_t* lengths, size_t count, uint8_t* out);
+
+	// Arrow-style string layout: item i is arena[offsets[i], offsets[i + 1]), so offsets holds count + 1 entries.
+	// Items are grouped by block count so lanes of a group finish together; digests still land at out + 32 * i.
+	// The last trailer bytes of every item are not hashed: a record separator, or the length prefix of the next item.
+	// Makes a single allocation per call, for the scheduling order.
+	static void hashArena(const uint8_t* arena, const uint32_t* offsets, size_t count, uint8_t* out, size_t trailer = 0);
+	static void hashArena(const uint8_t* arena, const uint64_t* offsets, size_t count, uint8_t* out, size_t trailer = 0);
+
+private:
+	template <typename Offset>
+	static void hashArenaImpl(const uint8_t* arena, const Offset* offsets, size_t count, uint8_t* out, size_t trailer);
+	// item(i, data, length) fetches item i; its digest goes to out + 32 * i
+	template <typename Item>
+	static void hashByBlocks(size_t count, Item item, uint8_t* out);
+	static void hashGroup(const uint8_t* const* data, const size_t* lengths, size_t count, uint8_t* const* out);
+	static void transform(uint32_t state[8][LANES], const uint32_t block[16][LANES], const uint32_t* mask);
+};
+
+#endif
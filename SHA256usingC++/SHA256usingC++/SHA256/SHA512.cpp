@@ -0,0 +1,18 @@
+#include "SHA512.h"
+#include <sstream>
+#include <iomanip>
+
+void SHA512::update(const std::string& data) {
+	update(reinterpret_cast<const uint8_t*> (data.c_str()), data.size());
+}
+
+std::string SHA512::toString(const uint8_t* digest) {
+	std::stringstream s;
+	s << std::setfill('0') << std::hex;
+
+	for (uint8_t i = 0; i < 64; i++) {
+		s << std::setw(2) << (unsigned int)digest[i];
+	}
+
+	return s.str();
+}
@@ -0,0 +1,180 @@
+#ifndef SHA512_H
+#define SHA512_H
+
+#include <string>
+#include <cstdint>
+#include <array>
+
+// SHA-512 with the same interface as SHA256, on 128 byte blocks and 64-bit words. Like SHA256
+// it is constexpr up to digest(uint8_t*), for ConstexprSHA.
+class SHA512 {
+
+public:
+	static constexpr size_t SIZE = 64;
+	static constexpr size_t BLOCK = 128;
+
+	constexpr SHA512();
+	constexpr void update(const uint8_t* data, size_t length);
+	void update(const std::string& data);
+	// Writes the 64 byte digest into hash.
+	constexpr void digest(uint8_t* hash);
+
+	static std::string toString(const uint8_t* digest);
+
+private:
+	uint8_t  m_data[128];
+	uint32_t m_blocklen;
+	uint64_t m_bitlen;
+	uint64_t m_state[8]; //A, B, C, D, E, F, G, H
+
+	static constexpr std::array<uint64_t, 80> K = {
+		0x428a2f98d728ae22,0x7137449123ef65cd,0xb5c0fbcfec4d3b2f,0xe9b5dba58189dbbc,
+		0x3956c25bf348b538,0x59f111f1b605d019,0x923f82a4af194f9b,0xab1c5ed5da6d8118,
+		0xd807aa98a3030242,0x12835b0145706fbe,0x243185be4ee4b28c,0x550c7dc3d5ffb4e2,
+		0x72be5d74f27b896f,0x80deb1fe3b1696b1,0x9bdc06a725c71235,0xc19bf174cf692694,
+		0xe49b69c19ef14ad2,0xefbe4786384f25e3,0x0fc19dc68b8cd5b5,0x240ca1cc77ac9c65,
+		0x2de92c6f592b0275,0x4a7484aa6ea6e483,0x5cb0a9dcbd41fbd4,0x76f988da831153b5,
+		0x983e5152ee66dfab,0xa831c66d2db43210,0xb00327c898fb213f,0xbf597fc7beef0ee4,
+		0xc6e00bf33da88fc2,0xd5a79147930aa725,0x06ca6351e003826f,0x142929670a0e6e70,
+		0x27b70a8546d22ffc,0x2e1b21385c26c926,0x4d2c6dfc5ac42aed,0x53380d139d95b3df,
+		0x650a73548baf63de,0x766a0abb3c77b2a8,0x81c2c92e47edaee6,0x92722c851482353b,
+		0xa2bfe8a14cf10364,0xa81a664bbc423001,0xc24b8b70d0f89791,0xc76c51a30654be30,
+		0xd192e819d6ef5218,0xd69906245565a910,0xf40e35855771202a,0x106aa07032bbd1b8,
+		0x19a4c116b8d2d0c8,0x1e376c085141ab53,0x2748774cdf8eeb99,0x34b0bcb5e19b48a8,
+		0x391c0cb3c5c95a63,0x4ed8aa4ae3418acb,0x5b9cca4f7763e373,0x682e6ff3d6b2b8a3,
+		0x748f82ee5defb2fc,0x78a5636f43172f60,0x84c87814a1f0ab72,0x8cc702081a6439ec,
+		0x90befffa23631e28,0xa4506cebde82bde9,0xbef9a3f7b2c67915,0xc67178f2e372532b,
+		0xca273eceea26619c,0xd186b8c721c0c207,0xeada7dd6cde0eb1e,0xf57d4f7fee6ed178,
+		0x06f067aa72176fba,0x0a637dc5a2c898a6,0x113f9804bef90dae,0x1b710b35131c471b,
+		0x28db77f523047d84,0x32caab7b40c72493,0x3c9ebe0a15c9bebc,0x431d67c49c100d4c,
+		0x4cc5d4becb3e42b6,0x597f299cfc657e2a,0x5fcb6fab3ad6faec,0x6c44198c4a475817
+	};
+
+	static constexpr uint64_t rotr(uint64_t x, uint64_t n);
+	constexpr void transform(const uint8_t* block);
+	constexpr void pad();
+	constexpr void revert(uint8_t* hash) const;
+};
+
+// Defined here so they can be evaluated at compile time, as in SHA256.h
+
+constexpr SHA512::SHA512()
+	: m_data{}, m_blocklen(0), m_bitlen(0),
+	m_state{
+		0x6a09e667f3bcc908, 0xbb67ae8584caa73b, 0x3c6ef372fe94f82b, 0xa54ff53a5f1d36f1,
+		0x510e527fade682d1, 0x9b05688c2b3e6c1f, 0x1f83d9abfb41bd6b, 0x5be0cd19137e2179
+	} {
+}
+
+constexpr void SHA512::update(const uint8_t* data, size_t length) {
+	while (length > 0) {
+		if (m_blocklen == 0 && length >= 128) {
+			transform(data);
+			m_bitlen += 1024;
+			data += 128;
+			length -= 128;
+			continue;
+		}
+
+		size_t take = 128 - m_blocklen < length ? 128 - m_blocklen : length;
+		for (size_t i = 0; i < take; i++) {
+			m_data[m_blocklen + i] = data[i];
+		}
+		m_blocklen += (uint32_t)take;
+		data += take;
+		length -= take;
+
+		if (m_blocklen == 128) {
+			transform(m_data);
+
+			m_bitlen += 1024;
+			m_blocklen = 0;
+		}
+	}
+}
+
+constexpr void SHA512::digest(uint8_t* hash) {
+	pad();
+	revert(hash);
+}
+
+constexpr uint64_t SHA512::rotr(uint64_t x, uint64_t n) {
+	return (x >> n) | (x << (64 - n));
+}
+
+constexpr void SHA512::transform(const uint8_t* block) {
+	uint64_t m[80] = {};
+	uint64_t state[8] = {};
+
+	for (uint8_t i = 0; i < 16; i++) {
+		for (uint8_t j = 0; j < 8; j++) {
+			m[i] = (m[i] << 8) | block[i * 8 + j];
+		}
+	}
+
+	for (uint8_t k = 16; k < 80; k++) {
+		uint64_t s0 = rotr(m[k - 15], 1) ^ rotr(m[k - 15], 8) ^ (m[k - 15] >> 7);
+		uint64_t s1 = rotr(m[k - 2], 19) ^ rotr(m[k - 2], 61) ^ (m[k - 2] >> 6);
+		m[k] = s1 + m[k - 7] + s0 + m[k - 16];
+	}
+
+	for (uint8_t i = 0; i < 8; i++) {
+		state[i] = m_state[i];
+	}
+
+	for (uint8_t i = 0; i < 80; i++) {
+		uint64_t maj = (state[0] & (state[1] | state[2])) | (state[1] & state[2]);
+		uint64_t xorA = rotr(state[0], 28) ^ rotr(state[0], 34) ^ rotr(state[0], 39);
+		uint64_t ch = (state[4] & state[5]) ^ (~state[4] & state[6]);
+		uint64_t xorE = rotr(state[4], 14) ^ rotr(state[4], 18) ^ rotr(state[4], 41);
+		uint64_t sum = m[i] + K[i] + state[7] + ch + xorE;
+
+		state[7] = state[6];
+		state[6] = state[5];
+		state[5] = state[4];
+		state[4] = state[3] + sum;
+		state[3] = state[2];
+		state[2] = state[1];
+		state[1] = state[0];
+		state[0] = xorA + maj + sum;
+	}
+
+	for (uint8_t i = 0; i < 8; i++) {
+		m_state[i] += state[i];
+	}
+}
+
+constexpr void SHA512::pad() {
+	uint64_t i = m_blocklen;
+	uint8_t end = m_blocklen < 112 ? 112 : 128;
+
+	m_data[i++] = 0x80;
+	while (i < end) {
+		m_data[i++] = 0x00;
+	}
+
+	if (m_blocklen >= 112) {
+		transform(m_data);
+		for (i = 0; i < 112; i++) {
+			m_data[i] = 0x00;
+		}
+	}
+
+	// 128-bit message length; the high half is always zero here
+	m_bitlen += m_blocklen * 8;
+	for (uint8_t j = 0; j < 8; j++) {
+		m_data[119 - j] = 0x00;
+		m_data[127 - j] = (uint8_t)(m_bitlen >> (8 * j));
+	}
+	transform(m_data);
+}
+
+constexpr void SHA512::revert(uint8_t* hash) const {
+	for (uint8_t j = 0; j < 8; j++) {
+		for (uint8_t i = 0; i < 8; i++) {
+			hash[j * 8 + i] = (uint8_t)(m_state[j] >> (56 - i * 8));
+		}
+	}
+}
+
+#endif
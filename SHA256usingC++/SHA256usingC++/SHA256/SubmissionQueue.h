@@ -0,0 +1,108 @@
+#ifndef SUBMISSION_QUEUE_H
+#define SUBMISSION_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+// Bounded lock-free multi-producer/multi-consumer queue (Vyukov's sequence-numbered ring).
+// Every cell carries a sequence number that tells producers and consumers whose turn it is,
+// so push and pop only contend on a single compare-and-swap each.
+template <typename T>
+class SubmissionQueue {
+
+public:
+	// Capacity is rounded up to a power of two.
+	explicit SubmissionQueue(size_t capacity) : m_head(0), m_tail(0) {
+		size_t size = 2;
+		while (size < capacity) {
+			size <<= 1;
+		}
+		m_mask = size - 1;
+		m_cells.reset(new Cell[size]);
+		for (size_t i = 0; i < size; i++) {
+			m_cells[i].sequence.store(i, std::memory_order_relaxed);
+		}
+	}
+
+	SubmissionQueue(const SubmissionQueue&) = delete;
+	SubmissionQueue& operator=(const SubmissionQueue&) = delete;
+
+	// Returns false when the queue is full.
+	bool push(const T& item) {
+		size_t pos = m_tail.load(std::memory_order_relaxed);
+		for (;;) {
+			Cell& cell = m_cells[pos & m_mask];
+			size_t seq = cell.sequence.load(std::memory_order_acquire);
+			intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+			if (diff == 0) {
+				if (m_tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+					cell.item = item;
+					cell.sequence.store(pos + 1, std::memory_order_release);
+					return true;
+				}
+			}
+			else if (diff < 0) {
+				return false;
+			}
+			else {
+				pos = m_tail.load(std::memory_order_relaxed);
+			}
+		}
+	}
+
+	// Returns false when the queue is empty.
+	bool pop(T& item) {
+		size_t pos = m_head.load(std::memory_order_relaxed);
+		for (;;) {
+			Cell& cell = m_cells[pos & m_mask];
+			size_t seq = cell.sequence.load(std::memory_order_acquire);
+			intptr_t diff = (intptr_t)seq - (intptr_t)(pos + 1);
+			if (diff == 0) {
+				if (m_head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+					item = cell.item;
+					cell.sequence.store(pos + m_mask + 1, std::memory_order_release);
+					return true;
+				}
+			}
+			else if (diff < 0) {
+				return false;
+			}
+			else {
+				pos = m_head.load(std::memory_order_relaxed);
+			}
+		}
+	}
+
+	// Pops up to max items into out, returns how many were taken.
+	size_t popMany(T* out, size_t max) {
+		size_t n = 0;
+		while (n < max && pop(out[n])) {
+			n++;
+		}
+		return n;
+	}
+
+	// True when the cell at the head has not been published yet. A push still in progress counts
+	// as empty; a stale head only ever reads as not empty, so callers may see false positives.
+	bool empty() const {
+		size_t pos = m_head.load(std::memory_order_relaxed);
+		size_t seq = m_cells[pos & m_mask].sequence.load(std::memory_order_acquire);
+		return (intptr_t)seq - (intptr_t)(pos + 1) < 0;
+	}
+
+private:
+	struct Cell {
+		std::atomic<size_t> sequence;
+		T item;
+	};
+
+	std::unique_ptr<Cell[]> m_cells;
+	size_t m_mask;
+	// Producers and consumers each get their own cache line
+	alignas(64) std::atomic<size_t> m_head;
+	alignas(64) std::atomic<size_t> m_tail;
+};
+
+#endif
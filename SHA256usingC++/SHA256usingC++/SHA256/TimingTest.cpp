@@ -0,0 +1,115 @@
+#include "TimingTest.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <random>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define HAVE_RDTSC 1
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define HAVE_RDTSC 1
+#endif
+
+static const size_t BATCH = 10000;
+static const size_t CROPS = 20;
+
+TimingTest::TimingTest(const std::string& name, Kernel kernel, size_t length)
+	: m_name(name), m_kernel(kernel), m_length(length) {
+}
+
+const std::string& TimingTest::name() const {
+	return m_name;
+}
+
+volatile uint8_t& TimingTest::sink() {
+	static volatile uint8_t value = 0;
+	return value;
+}
+
+uint64_t TimingTest::now() {
+#ifdef HAVE_RDTSC
+	_mm_lfence();
+	return __rdtsc();
+#else
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+void TimingTest::Welch::push(double x, int cls) {
+	// Welford's online mean and variance
+	n[cls]++;
+	double delta = x - mean[cls];
+	mean[cls] += delta / n[cls];
+	m2[cls] += delta * (x - mean[cls]);
+}
+
+double TimingTest::Welch::t() const {
+	if (n[0] < 2 || n[1] < 2) {
+		return 0;
+	}
+	double var0 = m2[0] / (n[0] - 1);
+	double var1 = m2[1] / (n[1] - 1);
+	double den = std::sqrt(var0 / n[0] + var1 / n[1]);
+	return den > 0 ? (mean[0] - mean[1]) / den : 0;
+}
+
+double TimingTest::percentile(std::vector<uint64_t> samples, double fraction) {
+	size_t index = (size_t)(fraction * (samples.size() - 1));
+	std::nth_element(samples.begin(), samples.begin() + index, samples.end());
+	return (double)samples[index];
+}
+
+double TimingTest::run(size_t measurements) {
+	std::mt19937_64 rng(std::random_device{}());
+	std::vector<uint8_t> inputs(BATCH * m_length);
+	std::vector<int> classes(BATCH);
+	std::vector<uint64_t> times(BATCH);
+
+	// Test 0 sees every sample, test i only those below the i-th crop threshold
+	Welch tests[CROPS + 1] = {};
+	double crop[CROPS];
+	bool calibrated = false;
+
+	for (size_t done = 0; done < measurements; done += BATCH) {
+		for (size_t i = 0; i < BATCH; i++) {
+			classes[i] = (int)(rng() & 1);
+			uint8_t* input = &inputs[i * m_length];
+			for (size_t j = 0; j < m_length; j++) {
+				input[j] = classes[i] ? (uint8_t)rng() : 0;
+			}
+		}
+
+		for (size_t i = 0; i < BATCH; i++) {
+			uint64_t start = now();
+			m_kernel(&inputs[i * m_length], m_length);
+			times[i] = now() - start;
+		}
+
+		// The first batch only warms up and places the crop thresholds
+		if (!calibrated) {
+			for (size_t c = 0; c < CROPS; c++) {
+				crop[c] = percentile(times, 1 - std::pow(0.5, 10.0 * (c + 1) / CROPS));
+			}
+			calibrated = true;
+			continue;
+		}
+
+		for (size_t i = 0; i < BATCH; i++) {
+			double x = (double)times[i];
+			tests[0].push(x, classes[i]);
+			for (size_t c = 0; c < CROPS; c++) {
+				if (x < crop[c]) {
+					tests[c + 1].push(x, classes[i]);
+				}
+			}
+		}
+	}
+
+	double worst = 0;
+	for (const Welch& test : tests) {
+		worst = std::max(worst, std::fabs(test.t()));
+	}
+	return worst;
+}
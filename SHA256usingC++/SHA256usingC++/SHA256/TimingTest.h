@@ -0,0 +1,50 @@
+#ifndef TIMING_TEST_H
+#define TIMING_TEST_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// dudect-style leakage detection (Reparaz, Balasch, Verbauwhede, "dude, is my code constant time?").
+// A kernel runs on two classes of secret input, a fixed value and fresh random values, interleaved
+// in random order. Welch's t-test then compares the two timing distributions, both raw and with the
+// slow tail cropped at several percentiles. A large |t| means the run time depends on the secret.
+class TimingTest {
+
+public:
+	// |t| above this is treated as a leak, as in dudect.
+	static constexpr double THRESHOLD = 10.0;
+
+	// Processes length bytes of secret input. The kernel must not be optimised away,
+	// so it should fold its output into sink().
+	typedef void (*Kernel)(const uint8_t* input, size_t length);
+
+	TimingTest(const std::string& name, Kernel kernel, size_t length);
+
+	// Takes the given number of measurements and returns the largest |t| seen.
+	double run(size_t measurements);
+
+	const std::string& name() const;
+
+	static volatile uint8_t& sink();
+
+private:
+	struct Welch {
+		double n[2];
+		double mean[2];
+		double m2[2];
+
+		void push(double x, int cls);
+		double t() const;
+	};
+
+	std::string m_name;
+	Kernel m_kernel;
+	size_t m_length;
+
+	static uint64_t now();
+	static double percentile(std::vector<uint64_t> samples, double fraction);
+};
+
+#endif
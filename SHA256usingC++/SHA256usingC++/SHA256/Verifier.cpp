@@ -0,0 +1,231 @@
+#include "Verifier.h"
+#include "SHA256.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <set>
+#include <thread>
+#include <utility>
+
+static const size_t CHUNK = 4 * 1024 * 1024;
+
+Verifier::Verifier(size_t threads, bool failFast, const std::string& checkpoint)
+	: m_threads(threads ? threads : 1), m_failFast(failFast), m_checkpoint(checkpoint), m_next(0), m_stop(false), m_failures(0) {
+}
+
+static int hexValue(char c) {
+	if (c >= '0' && c <= '9') return c - '0';
+	if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+	if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+	return -1;
+}
+
+bool Verifier::load(const std::string& manifest, std::ostream& out) {
+	std::ifstream in(manifest);
+	if (!in) {
+		return false;
+	}
+
+	std::string line;
+	size_t number = 0;
+	while (std::getline(in, line)) {
+		number++;
+		if (!line.empty() && line.back() == '\r') {
+			line.pop_back();
+		}
+		if (line.empty()) {
+			continue;
+		}
+
+		// 64 hex digits, a space, then a space (text) or '*' (binary) before the path
+		Entry entry;
+		bool valid = line.size() > 66 && line[64] == ' ' && (line[65] == ' ' || line[65] == '*');
+		for (size_t i = 0; valid && i < 32; i++) {
+			int hi = hexValue(line[i * 2]), lo = hexValue(line[i * 2 + 1]);
+			valid = hi >= 0 && lo >= 0;
+			entry.digest[i] = (uint8_t)((hi << 4) | lo);
+		}
+		if (!valid) {
+			out << manifest << ":" << number << ": improperly formatted line" << std::endl;
+			m_failures++;
+			continue;
+		}
+
+		std::error_code error;
+		entry.index = m_entries.size();
+		entry.path = line.substr(66);
+		entry.size = std::filesystem::file_size(entry.path, error);
+		if (error) {
+			entry.size = 0;
+		}
+		m_entries.push_back(entry);
+	}
+	return true;
+}
+
+int Verifier::verify(const std::string& manifest, std::ostream& out) {
+	if (!load(manifest, out)) {
+		return -1;
+	}
+
+	// Drop entries a previous run already verified, matched on both index and path
+	std::set<std::pair<size_t, std::string>> done;
+	if (!m_checkpoint.empty()) {
+		std::ifstream previous(m_checkpoint);
+		size_t index;
+		std::string path;
+		while (previous >> index && previous.get() == ' ' && std::getline(previous, path)) {
+			done.insert(std::make_pair(index, path));
+		}
+	}
+	m_entries.erase(std::remove_if(m_entries.begin(), m_entries.end(), [&done](const Entry& entry) {
+		return done.count(std::make_pair(entry.index, entry.path)) != 0;
+	}), m_entries.end());
+
+	std::sort(m_entries.begin(), m_entries.end(), [](const Entry& a, const Entry& b) {
+		return a.size > b.size;
+	});
+
+	std::ofstream checkpoint;
+	if (!m_checkpoint.empty()) {
+		checkpoint.open(m_checkpoint, std::ios::app);
+	}
+
+	std::vector<std::thread> workers;
+	for (size_t i = 0; i < m_threads; i++) {
+		workers.emplace_back(&Verifier::worker, this, std::ref(out), checkpoint.is_open() ? &checkpoint : nullptr);
+	}
+	for (auto& t : workers) {
+		t.join();
+	}
+
+	return m_failures;
+}
+
+void Verifier::worker(std::ostream& out, std::ostream* checkpoint) {
+	Reader reader;
+	uint8_t digest[32];
+
+	while (!m_stop) {
+		size_t i = m_next++;
+		if (i >= m_entries.size()) {
+			return;
+		}
+
+		const Entry& entry = m_entries[i];
+		bool read = hashFile(entry.path, reader, digest);
+		bool ok = read && memcmp(digest, entry.digest, 32) == 0;
+
+		std::lock_guard<std::mutex> lock(m_outputMutex);
+		if (ok) {
+			out << entry.path << ": OK" << std::endl;
+			if (checkpoint) {
+				*checkpoint << entry.index << ' ' << entry.path << std::endl;
+			}
+			continue;
+		}
+
+		out << entry.path << (read ? ": FAILED" : ": FAILED open or read") << std::endl;
+		m_failures++;
+		if (m_failFast) {
+			m_stop = true;
+		}
+	}
+}
+
+bool Verifier::hashFile(const std::string& path, uint8_t* digest) {
+	Reader reader;
+	return hashFile(path, reader, digest);
+}
+
+bool Verifier::hashFile(const std::string& path, Reader& reader, uint8_t* digest) {
+	FILE* file = fopen(path.c_str(), "rb");
+	if (!file) {
+		return false;
+	}
+
+	// fread only comes up short at the end of the file, so a file that fits in one chunk is done
+	// after the first read and never involves the reader thread
+	SHA256 sha;
+	size_t current = 0;
+	size_t got = fread(reader.buffer(current), 1, CHUNK, file);
+	while (got == CHUNK) {
+		reader.start(file, reader.buffer(current ^ 1));
+		sha.update(reader.buffer(current), got);
+		got = reader.finish();
+		current ^= 1;
+	}
+	sha.update(reader.buffer(current), got);
+
+	bool ok = !ferror(file);
+	fclose(file);
+	if (ok) {
+		sha.digest(digest);
+	}
+	return ok;
+}
+
+Verifier::Reader::Reader()
+	: m_file(nullptr), m_into(nullptr), m_got(0), m_ready(false), m_stopping(false) {
+}
+
+Verifier::Reader::~Reader() {
+	if (m_thread.joinable()) {
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_stopping = true;
+		}
+		m_changed.notify_all();
+		m_thread.join();
+	}
+}
+
+uint8_t* Verifier::Reader::buffer(size_t i) {
+	// Left uninitialised, every byte hashed is read into it first
+	if (!m_buffers) {
+		m_buffers.reset(new uint8_t[2 * CHUNK]);
+	}
+	return m_buffers.get() + i * CHUNK;
+}
+
+void Verifier::Reader::start(FILE* file, uint8_t* into) {
+	if (!m_thread.joinable()) {
+		m_thread = std::thread(&Reader::run, this);
+	}
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_file = file;
+		m_into = into;
+		m_ready = false;
+	}
+	m_changed.notify_all();
+}
+
+size_t Verifier::Reader::finish() {
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_changed.wait(lock, [this] { return m_ready; });
+	return m_got;
+}
+
+void Verifier::Reader::run() {
+	std::unique_lock<std::mutex> lock(m_mutex);
+	while (true) {
+		m_changed.wait(lock, [this] { return m_stopping || m_file; });
+		if (m_stopping) {
+			return;
+		}
+
+		FILE* file = m_file;
+		uint8_t* into = m_into;
+		m_file = nullptr;
+		lock.unlock();
+		size_t got = fread(into, 1, CHUNK, file);
+		lock.lock();
+
+		m_got = got;
+		m_ready = true;
+		m_changed.notify_all();
+	}
+}
@@ -0,0 +1,85 @@
+#ifndef VERIFIER_H
+#define VERIFIER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Checks files against a manifest of "digest  path" lines (the sha256sum format) on a pool of
+// threads. Entries are handed out largest file first so one big file does not end up as a
+// single-threaded tail. A file that fits in one chunk is read in a single call; for larger ones
+// each worker's reader thread fetches the next chunk while the current one is hashed.
+//
+// With a checkpoint file, every verified entry is appended to it as it completes and entries
+// already listed there are skipped, so an interrupted run picks up where it stopped.
+class Verifier {
+
+public:
+	Verifier(size_t threads, bool failFast, const std::string& checkpoint);
+
+	// Prints "path: OK" or "path: FAILED" per entry, returns the number of failures or -1 if
+	// the manifest cannot be read.
+	int verify(const std::string& manifest, std::ostream& out);
+
+	// Hashes a whole file, returns false if it cannot be read.
+	static bool hashFile(const std::string& path, uint8_t* digest);
+
+private:
+	// Per worker: two chunk buffers reused for every file, and a thread that reads one chunk ahead.
+	// Both are created on first use and last until the worker ends.
+	class Reader {
+
+	public:
+		Reader();
+		~Reader();
+
+		uint8_t* buffer(size_t i);
+
+		// Starts reading up to a chunk of file into into, finish() waits and returns the count read
+		void start(FILE* file, uint8_t* into);
+		size_t finish();
+
+	private:
+		std::unique_ptr<uint8_t[]> m_buffers;
+		std::thread m_thread;
+		std::mutex m_mutex;
+		std::condition_variable m_changed;
+		FILE* m_file;
+		uint8_t* m_into;
+		size_t m_got;
+		bool m_ready;
+		bool m_stopping;
+
+		void run();
+	};
+
+	struct Entry {
+		size_t index;
+		std::string path;
+		uint8_t digest[32];
+		uint64_t size;
+	};
+
+	size_t m_threads;
+	bool m_failFast;
+	std::string m_checkpoint;
+
+	std::vector<Entry> m_entries;
+	std::atomic<size_t> m_next;
+	std::atomic<bool> m_stop;
+	std::atomic<int> m_failures;
+	std::mutex m_outputMutex;
+
+	bool load(const std::string& manifest, std::ostream& out);
+	void worker(std::ostream& out, std::ostream* checkpoint);
+	static bool hashFile(const std::string& path, Reader& reader, uint8_t* digest);
+};
+
+#endif
@@ -1,10 +1,463 @@
 #include <iostream>
+#include <atomic>
 #include <chrono>
 #include <ctime>
+#include <csignal>
+#include <cstring>
+#include <thread>
+#include "SHA1.h"
+#include "SHA1Batch.h"
 #include "SHA256.h"
+#include "SHA512.h"
+#include "HashServer.h"
+#include "HashPool.h"
+#include "SHA256Batch.h"
+#include "TimingTest.h"
+#include "Verifier.h"
+#include "MerkleTree.h"
+#include "AES.h"
+#include "GCM.h"
+#include "HMAC.h"
+#include "Container.h"
+#include "Random.h"
+#include "Montgomery.h"
+#include "RSAKey.h"
+#include "RecordHasher.h"
+
+static HashServer* g_server = nullptr;
+
+static void onSignal(int) {
+	if (g_server) {
+		g_server->stop();
+	}
+}
+
+// --serve <socket> [workers] [batch]
+static int serve(int argc, char ** argv) {
+	if (argc < 3) {
+		std::cerr << "Usage: " << argv[0] << " --serve <socket> [workers] [batch]" << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	size_t workers = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : std::thread::hardware_concurrency();
+	size_t batch = argc > 4 ? std::strtoul(argv[4], nullptr, 10) : 64;
+
+	HashServer server(argv[2], workers, batch);
+	g_server = &server;
+	std::signal(SIGINT, onSignal);
+	std::signal(SIGTERM, onSignal);
+
+	bool ok = server.run();
+	g_server = nullptr;
+	if (!ok) {
+		std::cerr << "Could not listen on " << argv[2] << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	std::cerr << server.stats() << std::endl;
+	return EXIT_SUCCESS;
+}
+
+static void timeSHA256(const uint8_t* input, size_t length) {
+	uint8_t digest[32];
+	SHA256 sha;
+	sha.update(input, length);
+	sha.digest(digest);
+	TimingTest::sink() ^= digest[0];
+}
+
+static void timeSHA512(const uint8_t* input, size_t length) {
+	uint8_t digest[SHA512::SIZE];
+	SHA512 sha;
+	sha.update(input, length);
+	sha.digest(digest);
+	TimingTest::sink() ^= digest[0];
+}
+
+static void timeSHA256Batch(const uint8_t* input, size_t length) {
+	const uint8_t* data[SHA256Batch::LANES];
+	size_t lengths[SHA256Batch::LANES];
+	uint8_t digests[SHA256Batch::LANES * 32];
+	size_t lane = length / SHA256Batch::LANES;
+
+	for (size_t l = 0; l < SHA256Batch::LANES; l++) {
+		data[l] = input + l * lane;
+		lengths[l] = lane;
+	}
+	SHA256Batch::hash(data, lengths, SHA256Batch::LANES, digests);
+	TimingTest::sink() ^= digests[0];
+}
+
+static void timeSHA1(const uint8_t* input, size_t length) {
+	uint8_t digest[SHA1::SIZE];
+	SHA1 sha;
+	sha.update(input, length);
+	sha.digest(digest);
+	TimingTest::sink() ^= digest[0];
+}
+
+static void timeSHA1Batch(const uint8_t* input, size_t length) {
+	const uint8_t* data[SHA1Batch::LANES];
+	size_t lengths[SHA1Batch::LANES];
+	uint8_t digests[SHA1Batch::LANES * SHA1::SIZE];
+	size_t lane = length / SHA1Batch::LANES;
+
+	for (size_t l = 0; l < SHA1Batch::LANES; l++) {
+		data[l] = input + l * lane;
+		lengths[l] = lane;
+	}
+	SHA1Batch::hash(data, lengths, SHA1Batch::LANES, digests);
+	TimingTest::sink() ^= digests[0];
+}
+
+// Passphrase to AES key as over JNI, through the chained PBKDF2-HMAC-SHA1 loop. A 20 byte
+// output takes the single-chain path, 160 bytes the multi-lane one.
+static void timePBKDF2(const uint8_t* input, size_t length) {
+	static const uint8_t salt[] = "fa402db659644c9c881cde92013b2901";
+	uint8_t key[8 * SHA1::SIZE];
+	HMAC1::pbkdf2(input, length, salt, sizeof(salt) - 1, 4, key, SHA1::SIZE);
+	HMAC1::pbkdf2(input, length, salt, sizeof(salt) - 1, 4, key, sizeof(key));
+	TimingTest::sink() ^= key[0];
+}
+
+static void timeAES(const uint8_t* input, size_t length) {
+	uint8_t block[AES::BLOCK];
+	AES aes(input, 32);
+	for (size_t i = 32; i + AES::BLOCK <= length; i += AES::BLOCK) {
+		aes.encryptBlock(input + i, block);
+		TimingTest::sink() ^= block[0];
+	}
+}
+
+static void timeGCM(const uint8_t* input, size_t length) {
+	uint8_t out[256], tag[GCM::TAG_SIZE];
+	GCM gcm(input, 32);
+	gcm.seal(input + 32, input, 32, input + 44, length - 44, out, tag);
+	TimingTest::sink() ^= tag[0];
+}
+
+static void timeHMAC(const uint8_t* input, size_t length) {
+	uint8_t mac[HMAC::SIZE];
+	HMAC::mac(input, 32, input + 32, length - 32, mac);
+	TimingTest::sink() ^= mac[0];
+}
+
+static void timeChaCha20(const uint8_t* input, size_t length) {
+	uint8_t block[Random::LANES * 64];
+	Random::chacha20(input, 0, block);
+	TimingTest::sink() ^= block[length - 1];
+}
+
+static void timeMontgomery(const uint8_t* input, size_t length) {
+	// Secret exponent, as in RSA decryption and Miller-Rabin on a secret candidate
+	static const Montgomery mont((BigInt(1) << 512) - BigInt(569));
+	// Top bit set so both input classes give exponents of the same length
+	BigInt exponent = BigInt::fromBytes(input, length);
+	exponent.setBit(length * 8 - 1);
+	BigInt result = mont.pow(BigInt(3), exponent);
+	TimingTest::sink() ^= (uint8_t)(result.isOdd());
+}
+
+static std::atomic<size_t> g_poolDone(0);
+
+static void poolDone(void* context, const uint8_t* digest) {
+	memcpy(context, digest, 32);
+	g_poolDone.fetch_add(1, std::memory_order_release);
+}
+
+// --pool-check [producers] [workers] [messages]
+// Hashes messages of assorted lengths from several threads through HashPool and checks every
+// digest against SHA256. Producers pause between bursts so idle workers park and must be woken.
+static int poolCheck(int argc, char ** argv) {
+	size_t producers = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 4;
+	size_t workers = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : std::thread::hardware_concurrency();
+	size_t messages = argc > 4 ? std::strtoul(argv[4], nullptr, 10) : 200000;
+	const size_t BURST = 1000;
+	if (producers == 0) {
+		producers = 1;
+	}
+
+	std::vector<uint8_t> data(64 * 1024);
+	Random::fill(data.data(), data.size());
+	std::vector<uint8_t> digests(messages * 32);
+	g_poolDone = 0;
+
+	auto start = std::chrono::steady_clock::now();
+	{
+		HashPool pool(workers, 1024);
+		std::vector<std::thread> threads;
+		for (size_t p = 0; p < producers; p++) {
+			threads.emplace_back([&, p]() {
+				for (size_t i = p, n = 0; i < messages; i += producers, n++) {
+					if (n % BURST == BURST - 1) {
+						std::this_thread::sleep_for(std::chrono::milliseconds(2));
+					}
+					size_t length = (i * 7919) % 1500;
+					pool.submit(data.data() + (i * 104729) % (data.size() - length), length, poolDone, &digests[i * 32]);
+				}
+			});
+		}
+		for (auto& t : threads) {
+			t.join();
+		}
+		while (g_poolDone.load(std::memory_order_acquire) < messages) {
+			std::this_thread::yield();
+		}
+	}
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	size_t mismatches = 0;
+	for (size_t i = 0; i < messages; i++) {
+		size_t length = (i * 7919) % 1500;
+		SHA256 sha;
+		sha.update(data.data() + (i * 104729) % (data.size() - length), length);
+		uint8_t* digest = sha.digest();
+		mismatches += memcmp(digest, &digests[i * 32], 32) != 0;
+		delete[] digest;
+	}
+
+	std::cout << messages << " messages from " << producers << " producers in " << seconds * 1000 << " ms, "
+		<< mismatches << " mismatches" << std::endl;
+	return mismatches ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+// --timing [measurements]
+// Runs every kernel that handles secret data through the leakage test, fails if any of them leaks.
+static int timing(int argc, char ** argv) {
+	size_t measurements = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 1000000;
+
+	TimingTest tests[] = {
+		TimingTest("SHA256", timeSHA256, 64),
+		TimingTest("SHA256Batch", timeSHA256Batch, 8 * 64),
+		TimingTest("SHA512", timeSHA512, 128),
+		TimingTest("SHA1", timeSHA1, 64),
+		TimingTest("SHA1Batch", timeSHA1Batch, 8 * 64),
+		TimingTest("PBKDF2-SHA1", timePBKDF2, 32),
+		TimingTest("AES", timeAES, 32 + 4 * 16),
+		TimingTest("GCM", timeGCM, 44 + 64),
+		TimingTest("HMAC", timeHMAC, 32 + 64),
+		TimingTest("ChaCha20", timeChaCha20, 32),
+		TimingTest("Montgomery", timeMontgomery, 64),
+	};
+
+	int status = EXIT_SUCCESS;
+	for (TimingTest& test : tests) {
+		double t = test.run(measurements);
+		bool leaks = t > TimingTest::THRESHOLD;
+		std::cout << test.name() << ": max |t| = " << t << (leaks ? " LEAK" : " ok") << std::endl;
+		if (leaks) {
+			status = EXIT_FAILURE;
+		}
+	}
+
+	return status;
+}
+
+// -c <manifest> [-j threads] [--fail-fast] [--resume checkpoint]
+static int check(int argc, char ** argv) {
+	size_t threads = std::thread::hardware_concurrency();
+	bool failFast = false;
+	std::string checkpoint;
+
+	for (int i = 3; i < argc; i++) {
+		if (strcmp(argv[i], "-j") == 0 && i + 1 < argc) {
+			threads = std::strtoul(argv[++i], nullptr, 10);
+		}
+		else if (strcmp(argv[i], "--fail-fast") == 0) {
+			failFast = true;
+		}
+		else if (strcmp(argv[i], "--resume") == 0 && i + 1 < argc) {
+			checkpoint = argv[++i];
+		}
+		else {
+			std::cerr << "Unknown option " << argv[i] << std::endl;
+			return EXIT_FAILURE;
+		}
+	}
+
+	Verifier verifier(threads, failFast, checkpoint);
+	int failures = verifier.verify(argv[2], std::cout);
+	if (failures < 0) {
+		std::cerr << "Could not read " << argv[2] << std::endl;
+		return EXIT_FAILURE;
+	}
+	if (failures > 0) {
+		std::cerr << "WARNING: " << failures << " entries did not match" << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
+
+// --merkle build <image> <index>
+// --merkle update <image> <index> <block>...
+// --merkle proof <image> <index> <block>
+static int merkle(int argc, char ** argv) {
+	if (argc < 5) {
+		std::cerr << "Usage: " << argv[0] << " --merkle build|update|proof <image> <index> [block...]" << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	MerkleTree tree(std::thread::hardware_concurrency());
+	bool build = strcmp(argv[2], "build") == 0;
+	if (!(build ? tree.build(argv[3], argv[4]) : tree.open(argv[3], argv[4]))) {
+		std::cerr << "Could not " << (build ? "build " : "open ") << argv[4] << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	if (strcmp(argv[2], "update") == 0) {
+		std::vector<uint64_t> blocks;
+		for (int i = 5; i < argc; i++) {
+			blocks.push_back(std::strtoull(argv[i], nullptr, 10));
+			if (blocks.back() >= tree.leafCount()) {
+				std::cerr << "Block " << blocks.back() << " is past the end of the image" << std::endl;
+				return EXIT_FAILURE;
+			}
+		}
+		tree.update(blocks);
+	}
+	else if (strcmp(argv[2], "proof") == 0 && argc > 5) {
+		uint64_t block = std::strtoull(argv[5], nullptr, 10);
+		if (block >= tree.leafCount()) {
+			std::cerr << "Block " << block << " is past the end of the image" << std::endl;
+			return EXIT_FAILURE;
+		}
+		for (const MerkleTree::Hash& sibling : tree.proof(block)) {
+			std::cout << SHA256::toString(sibling.data()) << std::endl;
+		}
+	}
+
+	std::cout << SHA256::toString(tree.root().data()) << std::endl;
+	return EXIT_SUCCESS;
+}
+
+static bool parseKey(const char* hex, uint8_t* key) {
+	if (strlen(hex) != 64) {
+		return false;
+	}
+	for (size_t i = 0; i < 32; i++) {
+		char byte[3] = { hex[i * 2], hex[i * 2 + 1], 0 };
+		char* end;
+		key[i] = (uint8_t)std::strtoul(byte, &end, 16);
+		if (*end != 0) {
+			return false;
+		}
+	}
+	return true;
+}
+
+// --seal <hex key> <in> <out> [segment size]
+// --open <hex key> <in> <out>
+// --read <hex key> <in> <offset> <length>
+static int container(int argc, char ** argv) {
+	uint8_t key[32];
+	if (argc < 5 || !parseKey(argv[2], key)) {
+		std::cerr << "Usage: " << argv[0] << " --seal|--open <64 hex digit key> <in> <out> [segment size]" << std::endl;
+		std::cerr << "       " << argv[0] << " --read <64 hex digit key> <in> <offset> <length>" << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	Container box(key, sizeof(key), std::thread::hardware_concurrency());
+	memset(key, 0, sizeof(key));
+
+	if (strcmp(argv[1], "--seal") == 0) {
+		uint32_t segment = argc > 5 ? (uint32_t)std::strtoul(argv[5], nullptr, 10) : Container::DEFAULT_SEGMENT;
+		if (!box.seal(argv[3], argv[4], segment)) {
+			std::cerr << "Could not seal " << argv[3] << " into " << argv[4] << std::endl;
+			return EXIT_FAILURE;
+		}
+	}
+	else if (strcmp(argv[1], "--open") == 0) {
+		if (!box.open(argv[3], argv[4])) {
+			std::cerr << "Could not open " << argv[3] << ": unreadable or not authentic" << std::endl;
+			return EXIT_FAILURE;
+		}
+	}
+	else {
+		uint64_t offset = std::strtoull(argv[4], nullptr, 10);
+		size_t length = argc > 5 ? std::strtoul(argv[5], nullptr, 10) : 0;
+		std::vector<uint8_t> data(length);
+		if (!box.read(argv[3], offset, length, data.data())) {
+			std::cerr << "Could not read " << length << " bytes at " << offset << " from " << argv[3] << std::endl;
+			return EXIT_FAILURE;
+		}
+		std::cout.write((const char*)data.data(), data.size());
+	}
+
+	return EXIT_SUCCESS;
+}
+
+// --rsa-keygen <bits> [threads]
+// Prints the private and then the public key as rsa_kyx.py key_export_to_text does.
+static int rsaKeygen(int argc, char ** argv) {
+	size_t bits = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 0;
+	if (bits < 1024 || bits % 2 || bits > Montgomery::MAX_BITS) {
+		std::cerr << "Usage: " << argv[0] << " --rsa-keygen <bits> [threads]" << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	size_t threads = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : std::thread::hardware_concurrency();
+	RSAKey key = RSAKey::generate(bits, threads);
+	std::cout << key.privateText() << std::endl;
+	std::cout << key.publicText() << std::endl;
+	return EXIT_SUCCESS;
+}
+
+// --records [--prefixed] [-j threads] [file]
+// One digest line per input line, or per 4-byte big endian length-prefixed record; stdin without a file.
+static int records(int argc, char ** argv) {
+	RecordHasher::Format format = RecordHasher::LINES;
+	size_t threads = std::thread::hardware_concurrency();
+	std::string path = "-";
+
+	for (int i = 2; i < argc; i++) {
+		if (strcmp(argv[i], "--prefixed") == 0) {
+			format = RecordHasher::PREFIXED;
+		}
+		else if (strcmp(argv[i], "-j") == 0 && i + 1 < argc) {
+			threads = std::strtoul(argv[++i], nullptr, 10);
+		}
+		else {
+			path = argv[i];
+		}
+	}
+
+	std::ios::sync_with_stdio(false);
+	RecordHasher hasher(format, threads);
+	if (hasher.run(path, std::cout) < 0) {
+		std::cerr << "Could not read " << (path == "-" ? "stdin" : path) << " or it ends inside a record" << std::endl;
+		return EXIT_FAILURE;
+	}
+	return EXIT_SUCCESS;
+}
 
 int main(int argc, char ** argv) {
 
+	if (argc > 1 && strcmp(argv[1], "--serve") == 0) {
+		return serve(argc, argv);
+	}
+	if (argc > 1 && strcmp(argv[1], "--pool-check") == 0) {
+		return poolCheck(argc, argv);
+	}
+	if (argc > 1 && strcmp(argv[1], "--timing") == 0) {
+		return timing(argc, argv);
+	}
+	if (argc > 2 && strcmp(argv[1], "-c") == 0) {
+		return check(argc, argv);
+	}
+	if (argc > 1 && strcmp(argv[1], "--merkle") == 0) {
+		return merkle(argc, argv);
+	}
+	if (argc > 1 && (strcmp(argv[1], "--seal") == 0 || strcmp(argv[1], "--open") == 0 || strcmp(argv[1], "--read") == 0)) {
+		return container(argc, argv);
+	}
+	if (argc > 1 && strcmp(argv[1], "--rsa-keygen") == 0) {
+		return rsaKeygen(argc, argv);
+	}
+	if (argc > 1 && strcmp(argv[1], "--records") == 0) {
+		return records(argc, argv);
+	}
+
 	for (int i = 1; i < argc; i++) {
 		SHA256 sha;
 		sha.update(argv[i]);
@@ -0,0 +1,59 @@
+// C ABI over Cipher666, see engine666.h.
+
+#include "engine666.h"
+#include "Cipher666.h"
+#include <thread>
+
+static_assert(ENGINE666_MATRIX == Cipher666::MATRIX && ENGINE666_KEYS == Cipher666::KEYS, "engine666.h out of step with Cipher666");
+
+static size_t threadCount(int32_t threads) {
+	if (threads > 0) {
+		return (size_t)threads;
+	}
+	unsigned cores = std::thread::hardware_concurrency();
+	return cores ? cores : 1;
+}
+
+// The matrix comes in as UTF-16; anything outside ASCII becomes a non-digit and fails validation
+static void narrow(const uint16_t* wide, char* matrix) {
+	for (size_t i = 0; i < Cipher666::MATRIX; i++) {
+		matrix[i] = wide[i] < 0x80 ? (char)wide[i] : '?';
+	}
+}
+
+extern "C" {
+
+ENGINE666_API void engine666_generate(uint16_t* matrix, int32_t* keys) {
+	char digits[Cipher666::MATRIX];
+	Cipher666::generate(digits, keys);
+	for (size_t i = 0; i < Cipher666::MATRIX; i++) {
+		matrix[i] = (uint16_t)digits[i];
+	}
+}
+
+ENGINE666_API int64_t engine666_encrypt(const uint16_t* matrix, const int32_t* keys,
+	const uint16_t* text, int64_t length, uint16_t* out, int32_t threads) {
+	char digits[Cipher666::MATRIX];
+	narrow(matrix, digits);
+	Cipher666 cipher(digits, keys);
+	if (!cipher.valid() || length < 0) {
+		return -1;
+	}
+	return (int64_t)cipher.encrypt(text, (size_t)length, out, threadCount(threads));
+}
+
+ENGINE666_API int32_t engine666_decrypt(const int32_t* keys, const uint16_t* in, int64_t count,
+	uint16_t* out, int32_t threads) {
+	// Decryption only reads the key positions, so any matrix will do
+	char digits[Cipher666::MATRIX];
+	for (size_t i = 0; i < Cipher666::MATRIX; i++) {
+		digits[i] = '0';
+	}
+	Cipher666 cipher(digits, keys);
+	if (count < 0) {
+		return 0;
+	}
+	return cipher.decrypt(in, (size_t)count, out, threadCount(threads)) ? 1 : 0;
+}
+
+}
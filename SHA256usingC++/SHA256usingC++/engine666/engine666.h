@@ -0,0 +1,43 @@
+/* C ABI of the 666 matrix cipher engine (Cipher666), for the 666_app P/Invoke bindings.
+ *
+ * Text is UTF-16 as .NET strings hold it, one code unit per block. Matrices and encrypted
+ * text are UTF-16 digits as well, so managed strings pass through without conversion. All
+ * calls are stateless and thread safe. */
+#ifndef ENGINE666_H
+#define ENGINE666_H
+
+#include <stdint.h>
+
+#if defined(_WIN32)
+#define ENGINE666_API __declspec(dllexport)
+#else
+#define ENGINE666_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Characters per encrypted block, and the number of keys. */
+#define ENGINE666_MATRIX 108
+#define ENGINE666_KEYS 18
+
+/* Fills matrix (ENGINE666_MATRIX digits) and keys (ENGINE666_KEYS values) from the native
+ * cryptographic generator. */
+ENGINE666_API void engine666_generate(uint16_t* matrix, int32_t* keys);
+
+/* Encrypts length characters into out, which needs room for length * ENGINE666_MATRIX.
+ * threads == 0 uses every core. Returns the number of blocks written (0 when the key pairs
+ * 1/2, 3/4 or 5/6 are equal, as the app always did), or -1 for a malformed matrix or keys. */
+ENGINE666_API int64_t engine666_encrypt(const uint16_t* matrix, const int32_t* keys,
+	const uint16_t* text, int64_t length, uint16_t* out, int32_t threads);
+
+/* Decrypts count blocks into count characters. Returns 1, or 0 for malformed input. */
+ENGINE666_API int32_t engine666_decrypt(const int32_t* keys, const uint16_t* in, int64_t count,
+	uint16_t* out, int32_t threads);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,268 @@
+// JNI bindings for com.biomiid.encryption.NativeCrypto.
+//
+// Bulk data is passed in direct ByteBuffers and used in place, so nothing is copied or
+// pinned on the way in or out. Keys are parsed once into native objects whose addresses go
+// back to Java as long handles; Java keeps them for as long as it uses the key and frees
+// them explicitly.
+
+#include <jni.h>
+
+#include <cstring>
+#include <new>
+#include <vector>
+#include "AES.h"
+#include "HMAC.h"
+#include "RSAPublicKey.h"
+#include "SHA256.h"
+#include "SHA256Batch.h"
+
+// Must match the HASH_ constants in NativeCrypto.java
+enum HashId {
+	HASH_SHA1 = 1,
+	HASH_SHA256 = 2,
+	HASH_SHA512 = 3
+};
+
+static void throwNew(JNIEnv* env, const char* type, const char* message) {
+	jclass cls = env->FindClass(type);
+	if (cls) {
+		env->ThrowNew(cls, message);
+	}
+}
+
+// Address of [offset, offset + length) in a direct buffer, or null with an exception pending.
+static uint8_t* address(JNIEnv* env, jobject buffer, jlong offset, jlong length) {
+	uint8_t* base = buffer ? (uint8_t*)env->GetDirectBufferAddress(buffer) : nullptr;
+	if (!base) {
+		throwNew(env, "java/lang/IllegalArgumentException", "expected a direct ByteBuffer");
+		return nullptr;
+	}
+	if (offset < 0 || length < 0 || offset + length > env->GetDirectBufferCapacity(buffer)) {
+		throwNew(env, "java/lang/IndexOutOfBoundsException", "range outside the buffer");
+		return nullptr;
+	}
+	return base + offset;
+}
+
+static std::vector<uint8_t> bytes(JNIEnv* env, jbyteArray array) {
+	std::vector<uint8_t> result(array ? (size_t)env->GetArrayLength(array) : 0);
+	if (!result.empty()) {
+		env->GetByteArrayRegion(array, 0, (jsize)result.size(), (jbyte*)result.data());
+	}
+	return result;
+}
+
+static void wipe(std::vector<uint8_t>& data) {
+	volatile uint8_t* p = data.data();
+	for (size_t i = 0; i < data.size(); i++) {
+		p[i] = 0;
+	}
+}
+
+static size_t hashSize(jint hash) {
+	switch (hash) {
+	case HASH_SHA1:
+		return SHA1::SIZE;
+	case HASH_SHA256:
+		return SHA256::SIZE;
+	case HASH_SHA512:
+		return SHA512::SIZE;
+	default:
+		return 0;
+	}
+}
+
+static bool encryptOAEP(const RSAPublicKey& key, jint hash, const uint8_t* in, size_t length, uint8_t* out) {
+	switch (hash) {
+	case HASH_SHA1:
+		return key.encryptOAEP<SHA1>(in, length, out);
+	case HASH_SHA256:
+		return key.encryptOAEP<SHA256>(in, length, out);
+	case HASH_SHA512:
+		return key.encryptOAEP<SHA512>(in, length, out);
+	default:
+		return false;
+	}
+}
+
+extern "C" {
+
+JNIEXPORT jboolean JNICALL Java_com_biomiid_encryption_NativeCrypto_nativeSupports(JNIEnv*, jclass, jint hash) {
+	return hashSize(hash) != 0;
+}
+
+JNIEXPORT jlong JNICALL Java_com_biomiid_encryption_NativeCrypto_rsaPublicKey(JNIEnv* env, jclass, jbyteArray der) {
+	std::vector<uint8_t> data = bytes(env, der);
+	RSAPublicKey* key = new (std::nothrow) RSAPublicKey();
+	if (!key) {
+		throwNew(env, "java/lang/OutOfMemoryError", "no memory for an RSA key");
+		return 0;
+	}
+	if (!key->parse(data.data(), data.size())) {
+		delete key;
+		throwNew(env, "java/lang/IllegalArgumentException", "not an RSA public key");
+		return 0;
+	}
+	return (jlong)(intptr_t)key;
+}
+
+JNIEXPORT void JNICALL Java_com_biomiid_encryption_NativeCrypto_rsaFree(JNIEnv*, jclass, jlong handle) {
+	delete (RSAPublicKey*)(intptr_t)handle;
+}
+
+JNIEXPORT jint JNICALL Java_com_biomiid_encryption_NativeCrypto_rsaSize(JNIEnv*, jclass, jlong handle) {
+	return (jint)((RSAPublicKey*)(intptr_t)handle)->size();
+}
+
+JNIEXPORT jint JNICALL Java_com_biomiid_encryption_NativeCrypto_rsaEncrypt(JNIEnv* env, jclass, jlong handle, jint hash,
+	jobject in, jint inOffset, jint length, jobject out, jint outOffset) {
+	const RSAPublicKey& key = *(RSAPublicKey*)(intptr_t)handle;
+	const uint8_t* src = address(env, in, inOffset, length);
+	uint8_t* dst = src ? address(env, out, outOffset, (jlong)key.size()) : nullptr;
+	if (!dst) {
+		return -1;
+	}
+
+	if (!encryptOAEP(key, hash, src, (size_t)length, dst)) {
+		throwNew(env, "java/lang/IllegalArgumentException", "message too long for the key, or unsupported hash");
+		return -1;
+	}
+	return (jint)key.size();
+}
+
+// Message i is in[offsets[i], offsets[i + 1]); its ciphertext goes to out + outOffset + i * size.
+JNIEXPORT jint JNICALL Java_com_biomiid_encryption_NativeCrypto_rsaEncryptBatch(JNIEnv* env, jclass, jlong handle, jint hash,
+	jobject in, jintArray offsets, jint count, jobject out, jint outOffset) {
+	const RSAPublicKey& key = *(RSAPublicKey*)(intptr_t)handle;
+	if (count < 0 || !offsets || env->GetArrayLength(offsets) < count + 1) {
+		throwNew(env, "java/lang/IllegalArgumentException", "offsets must hold count + 1 entries");
+		return -1;
+	}
+
+	std::vector<jint> bounds((size_t)count + 1);
+	env->GetIntArrayRegion(offsets, 0, count + 1, bounds.data());
+	const uint8_t* src = address(env, in, 0, bounds[count]);
+	uint8_t* dst = src ? address(env, out, outOffset, (jlong)count * (jlong)key.size()) : nullptr;
+	if (!dst) {
+		return -1;
+	}
+
+	for (jint i = 0; i < count; i++) {
+		if (bounds[i] < 0 || bounds[i + 1] < bounds[i] ||
+			!encryptOAEP(key, hash, src + bounds[i], (size_t)(bounds[i + 1] - bounds[i]), dst + (size_t)i * key.size())) {
+			throwNew(env, "java/lang/IllegalArgumentException", "bad offsets, message too long for the key, or unsupported hash");
+			return -1;
+		}
+	}
+	return count;
+}
+
+JNIEXPORT jboolean JNICALL Java_com_biomiid_encryption_NativeCrypto_pbkdf2(JNIEnv* env, jclass, jint hash,
+	jbyteArray password, jbyteArray salt, jint iterations, jbyteArray out) {
+	if (iterations < 1 || !out || hashSize(hash) == 0) {
+		return JNI_FALSE;
+	}
+
+	std::vector<uint8_t> p = bytes(env, password), s = bytes(env, salt);
+	std::vector<uint8_t> key((size_t)env->GetArrayLength(out));
+	if (hash == HASH_SHA1) {
+		HMAC1::pbkdf2(p.data(), p.size(), s.data(), s.size(), (uint32_t)iterations, key.data(), key.size());
+	}
+	else if (hash == HASH_SHA256) {
+		HMAC::pbkdf2(p.data(), p.size(), s.data(), s.size(), (uint32_t)iterations, key.data(), key.size());
+	}
+	else {
+		HMAC512::pbkdf2(p.data(), p.size(), s.data(), s.size(), (uint32_t)iterations, key.data(), key.size());
+	}
+	env->SetByteArrayRegion(out, 0, (jsize)key.size(), (const jbyte*)key.data());
+
+	wipe(p);
+	wipe(key);
+	return JNI_TRUE;
+}
+
+JNIEXPORT jlong JNICALL Java_com_biomiid_encryption_NativeCrypto_aesKey(JNIEnv* env, jclass, jbyteArray key) {
+	std::vector<uint8_t> k = bytes(env, key);
+	if (k.size() != 16 && k.size() != 24 && k.size() != 32) {
+		throwNew(env, "java/lang/IllegalArgumentException", "AES keys are 16, 24 or 32 bytes");
+		return 0;
+	}
+	AES* aes = new (std::nothrow) AES(k.data(), k.size());
+	wipe(k);
+	if (!aes) {
+		// A 0 handle must never reach Java, it would be cached and dereferenced later
+		throwNew(env, "java/lang/OutOfMemoryError", "no memory for an AES key");
+		return 0;
+	}
+	return (jlong)(intptr_t)aes;
+}
+
+JNIEXPORT void JNICALL Java_com_biomiid_encryption_NativeCrypto_aesFree(JNIEnv*, jclass, jlong handle) {
+	delete (AES*)(intptr_t)handle;
+}
+
+// AES-CBC with PKCS#5 padding, the Java "AES/CBC/PKCS5Padding". out needs room for
+// (length / 16 + 1) * 16 bytes; returns the number written.
+JNIEXPORT jint JNICALL Java_com_biomiid_encryption_NativeCrypto_aesCbcEncrypt(JNIEnv* env, jclass, jlong handle, jbyteArray iv,
+	jobject in, jint inOffset, jint length, jobject out, jint outOffset) {
+	const AES& aes = *(AES*)(intptr_t)handle;
+	jint written = (length / 16 + 1) * 16;
+	const uint8_t* src = address(env, in, inOffset, length);
+	uint8_t* dst = src ? address(env, out, outOffset, written) : nullptr;
+	if (!dst) {
+		return -1;
+	}
+	if (!iv || env->GetArrayLength(iv) != AES::BLOCK) {
+		throwNew(env, "java/lang/IllegalArgumentException", "the IV must be 16 bytes");
+		return -1;
+	}
+
+	uint8_t chain[AES::BLOCK], last[AES::BLOCK];
+	env->GetByteArrayRegion(iv, 0, AES::BLOCK, (jbyte*)chain);
+
+	size_t full = (size_t)length / 16;
+	aes.cbc(chain, src, dst, full);
+	size_t rest = (size_t)length % 16;
+	memcpy(last, src + full * 16, rest);
+	memset(last + rest, (int)(16 - rest), 16 - rest);
+	aes.cbc(chain, last, dst + full * 16, 1);
+	return written;
+}
+
+JNIEXPORT void JNICALL Java_com_biomiid_encryption_NativeCrypto_sha256(JNIEnv* env, jclass,
+	jobject in, jint inOffset, jint length, jobject out, jint outOffset) {
+	const uint8_t* src = address(env, in, inOffset, length);
+	uint8_t* dst = src ? address(env, out, outOffset, SHA256::SIZE) : nullptr;
+	if (dst) {
+		SHA256 sha;
+		sha.update(src, (size_t)length);
+		sha.digest(dst);
+	}
+}
+
+// Item i is in[offsets[i], offsets[i + 1]), hashed on the multi-buffer kernel; digest i goes to
+// out + outOffset + 32 * i.
+JNIEXPORT void JNICALL Java_com_biomiid_encryption_NativeCrypto_sha256Batch(JNIEnv* env, jclass,
+	jobject in, jintArray offsets, jint count, jobject out, jint outOffset) {
+	if (count < 0 || !offsets || env->GetArrayLength(offsets) < count + 1) {
+		throwNew(env, "java/lang/IllegalArgumentException", "offsets must hold count + 1 entries");
+		return;
+	}
+
+	std::vector<uint32_t> bounds((size_t)count + 1);
+	env->GetIntArrayRegion(offsets, 0, count + 1, (jint*)bounds.data());
+	for (jint i = 0; i < count; i++) {
+		if (bounds[i + 1] < bounds[i] || bounds[i + 1] > 0x7fffffffu) {
+			throwNew(env, "java/lang/IllegalArgumentException", "offsets must be ascending");
+			return;
+		}
+	}
+
+	const uint8_t* src = address(env, in, 0, bounds[count]);
+	uint8_t* dst = src ? address(env, out, outOffset, (jlong)count * SHA256::SIZE) : nullptr;
+	if (dst) {
+		SHA256Batch::hashArena(src, bounds.data(), (size_t)count, dst);
+	}
+}
+
+}
@@ -0,0 +1,215 @@
+// CPython bindings for the native SHA-1, SHA-256 and SHA-512 cores and the Random generator.
+//
+// Any object supporting the buffer protocol (bytes, bytearray, memoryview, mmap, numpy
+// arrays...) is hashed in place without a copy. Inputs of GIL_THRESHOLD bytes or more are
+// hashed with the GIL released, so Python threads hashing large inputs run in parallel;
+// the buffer stays exported while the GIL is released, so it cannot be resized underneath.
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+#include <cstring>
+#include <new>
+#include <vector>
+#include "SHA1.h"
+#include "SHA1Batch.h"
+#include "SHA256.h"
+#include "SHA512.h"
+#include "SHA256Batch.h"
+#include "Random.h"
+
+// Below this, releasing and retaking the GIL costs more than the hash
+static const Py_ssize_t GIL_THRESHOLD = 4096;
+
+static void hashSHA1(const uint8_t* data, size_t length, uint8_t* out) {
+	SHA1 sha;
+	sha.update(data, length);
+	sha.digest(out);
+}
+
+static void hashSHA256(const uint8_t* data, size_t length, uint8_t* out) {
+	SHA256 sha;
+	sha.update(data, length);
+	sha.digest(out);
+}
+
+static void hashSHA512(const uint8_t* data, size_t length, uint8_t* out) {
+	SHA512 sha;
+	sha.update(data, length);
+	sha.digest(out);
+}
+
+template <void (*Hash)(const uint8_t*, size_t, uint8_t*), size_t SIZE>
+static PyObject* digest(PyObject*, PyObject* arg) {
+	Py_buffer view;
+	if (PyObject_GetBuffer(arg, &view, PyBUF_SIMPLE) != 0) {
+		return nullptr;
+	}
+
+	uint8_t out[SIZE];
+	if (view.len >= GIL_THRESHOLD) {
+		Py_BEGIN_ALLOW_THREADS
+		Hash((const uint8_t*)view.buf, (size_t)view.len, out);
+		Py_END_ALLOW_THREADS
+	}
+	else {
+		Hash((const uint8_t*)view.buf, (size_t)view.len, out);
+	}
+
+	PyBuffer_Release(&view);
+	return PyBytes_FromStringAndSize((const char*)out, SIZE);
+}
+
+static PyObject* hashMany(PyObject*, PyObject* args, PyObject* kwargs) {
+	static const char* keywords[] = { "buffers", "algorithm", nullptr };
+	PyObject* sequence;
+	const char* algorithm = "sha256";
+	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|s", (char**)keywords, &sequence, &algorithm)) {
+		return nullptr;
+	}
+
+	size_t size;
+	if (strcmp(algorithm, "sha1") == 0) {
+		size = 20;
+	}
+	else if (strcmp(algorithm, "sha256") == 0) {
+		size = 32;
+	}
+	else if (strcmp(algorithm, "sha512") == 0) {
+		size = 64;
+	}
+	else {
+		PyErr_Format(PyExc_ValueError, "unsupported algorithm '%s'", algorithm);
+		return nullptr;
+	}
+
+	PyObject* items = PySequence_Fast(sequence, "buffers must be a sequence");
+	if (!items) {
+		return nullptr;
+	}
+	size_t count = (size_t)PySequence_Fast_GET_SIZE(items);
+
+	PyObject* result = nullptr;
+	std::vector<Py_buffer> views;
+	try {
+		views.reserve(count);
+		std::vector<const uint8_t*> data(count);
+		std::vector<size_t> lengths(count);
+		std::vector<uint8_t> digests(count * size);
+		Py_ssize_t total = 0;
+
+		for (size_t i = 0; i < count; i++) {
+			Py_buffer view;
+			if (PyObject_GetBuffer(PySequence_Fast_GET_ITEM(items, i), &view, PyBUF_SIMPLE) != 0) {
+				break;
+			}
+			views.push_back(view);
+			data[i] = (const uint8_t*)view.buf;
+			lengths[i] = (size_t)view.len;
+			total += view.len;
+		}
+
+		if (views.size() == count) {
+			auto run = [&]() {
+				if (size == 64) {
+					for (size_t i = 0; i < count; i++) {
+						hashSHA512(data[i], lengths[i], &digests[i * size]);
+					}
+				}
+				else if (size == 32) {
+					SHA256Batch::hashGrouped(data.data(), lengths.data(), count, digests.data());
+				}
+				else {
+					SHA1Batch::hash(data.data(), lengths.data(), count, digests.data());
+				}
+			};
+
+			// Every buffer stays exported until the end of the call, so the GIL can go for the whole batch
+			if (total >= GIL_THRESHOLD) {
+				Py_BEGIN_ALLOW_THREADS
+				run();
+				Py_END_ALLOW_THREADS
+			}
+			else {
+				run();
+			}
+
+			result = PyList_New((Py_ssize_t)count);
+			for (size_t i = 0; result && i < count; i++) {
+				PyObject* item = PyBytes_FromStringAndSize((const char*)&digests[i * size], (Py_ssize_t)size);
+				if (!item) {
+					Py_CLEAR(result);
+					break;
+				}
+				PyList_SET_ITEM(result, (Py_ssize_t)i, item);
+			}
+		}
+	}
+	catch (const std::bad_alloc&) {
+		PyErr_NoMemory();
+	}
+
+	for (Py_buffer& view : views) {
+		PyBuffer_Release(&view);
+	}
+	Py_DECREF(items);
+	return result;
+}
+
+static PyObject* randomBytes(PyObject*, PyObject* arg) {
+	Py_ssize_t length = PyNumber_AsSsize_t(arg, PyExc_OverflowError);
+	if (length == -1 && PyErr_Occurred()) {
+		return nullptr;
+	}
+	if (length < 0) {
+		PyErr_SetString(PyExc_ValueError, "length must not be negative");
+		return nullptr;
+	}
+
+	PyObject* result = PyBytes_FromStringAndSize(nullptr, length);
+	if (!result) {
+		return nullptr;
+	}
+
+	// The generator is per thread, so threads that release the GIL never share state
+	uint8_t* out = (uint8_t*)PyBytes_AS_STRING(result);
+	if (length >= GIL_THRESHOLD) {
+		Py_BEGIN_ALLOW_THREADS
+		Random::fill(out, (size_t)length);
+		Py_END_ALLOW_THREADS
+	}
+	else {
+		Random::fill(out, (size_t)length);
+	}
+	return result;
+}
+
+static PyMethodDef methods[] = {
+	{ "sha1", digest<hashSHA1, 20>, METH_O, "sha1(data) -> bytes\n\nSHA-1 digest of a bytes-like object, for legacy formats only." },
+	{ "sha256", digest<hashSHA256, 32>, METH_O, "sha256(data) -> bytes\n\nSHA-256 digest of a bytes-like object." },
+	{ "sha512", digest<hashSHA512, 64>, METH_O, "sha512(data) -> bytes\n\nSHA-512 digest of a bytes-like object." },
+	{ "hash_many", (PyCFunction)(void (*)(void))hashMany, METH_VARARGS | METH_KEYWORDS,
+		"hash_many(buffers, algorithm='sha256') -> list of bytes\n\n"
+		"Digests of every bytes-like object in buffers, in order. algorithm is 'sha1', 'sha256' or\n"
+		"'sha512'; sha256 and sha1 run on the multi-buffer kernels (sha256 first groups buffers of\n"
+		"similar length into the same lanes), sha512 one buffer after another. The GIL\n"
+		"is released for the whole batch once it totals GIL_THRESHOLD bytes." },
+	{ "random", randomBytes, METH_O, "random(n) -> bytes\n\n"
+		"n cryptographically secure random bytes from the native per-thread ChaCha20 generator,\n"
+		"seeded from the OS and reseeded after fork(). Usable wherever Crypto.Random.new().read is." },
+	{ nullptr, nullptr, 0, nullptr }
+};
+
+static struct PyModuleDef module = {
+	PyModuleDef_HEAD_INIT, "nativehash", "Native SHA-1, SHA-256 and SHA-512 over the buffer protocol, and random bytes.", -1, methods,
+	nullptr, nullptr, nullptr, nullptr
+};
+
+PyMODINIT_FUNC PyInit_nativehash(void) {
+	PyObject* m = PyModule_Create(&module);
+	if (m && PyModule_AddIntConstant(m, "GIL_THRESHOLD", GIL_THRESHOLD) != 0) {
+		Py_DECREF(m);
+		return nullptr;
+	}
+	return m;
+}
@@ -0,0 +1,20 @@
+# Builds the nativehash extension from the C++ sources in ../SHA256:
+#
+#   python setup.py build_ext --inplace
+import sys
+from setuptools import setup, Extension
+
+sources = ["nativehash.cpp"] + ["../SHA256/" + f for f in ("SHA1.cpp", "SHA1Batch.cpp", "SHA256.cpp", "SHA512.cpp", "SHA256Batch.cpp", "Random.cpp")]
+
+if sys.platform == "win32":
+    flags = ["/std:c++17", "/O2"]
+else:
+    # Hidden visibility lets the compiler inline the hash helpers despite -fPIC
+    flags = ["-std=c++17", "-O2", "-fvisibility=hidden"]
+
+setup(
+    name="nativehash",
+    version="1.0",
+    description="Native SHA-1, SHA-256 and SHA-512 over the buffer protocol, and random bytes",
+    ext_modules=[Extension("nativehash", sources=sources, include_dirs=["../SHA256"], extra_compile_args=flags, language="c++")],
+)